@@ -128,6 +128,8 @@ Copy-Item "$buildoutput\args.gn" -Destination "$OutputPath\lib\$AppPlatform\$Con
 # Headers
 Copy-Item "$jsigitpath\public\ScriptStore.h" -Destination "$OutputPath\build\native\include\"
 Copy-Item "$jsigitpath\public\V8JsiRuntime.h" -Destination "$OutputPath\build\native\include\"
+Copy-Item "$jsigitpath\public\V8JsiCoroutine.h" -Destination "$OutputPath\build\native\include\"
+Copy-Item "$jsigitpath\public\V8JsiDynamic.h" -Destination "$OutputPath\build\native\include\"
 
 Copy-Item "$jsigitpath\jsi\jsi.h" -Destination "$OutputPath\build\native\jsi\jsi\"
 Copy-Item "$jsigitpath\jsi\jsi-inl.h" -Destination "$OutputPath\build\native\jsi\jsi\"
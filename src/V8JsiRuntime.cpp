@@ -3,17 +3,27 @@
 #include "V8JsiRuntime_impl.h"
 
 #include "libplatform/libplatform.h"
+#include "v8-fast-api-calls.h"
 #include "v8.h"
 
 #include "V8Platform.h"
 #include "public/ScriptStore.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <list>
 #include <mutex>
 #include <sstream>
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define V8JSI_HAS_SSE2
+#endif
+
 #ifdef _WIN32
 #include <windows.h>
 #include "etw/tracing.h"
@@ -24,9 +34,7 @@ using namespace facebook;
 #ifndef _ISOLATE_CONTEXT_ENTER
 #define _ISOLATE_CONTEXT_ENTER                      \
   v8::Isolate *isolate = v8::Isolate::GetCurrent(); \
-  v8::Isolate::Scope isolate_scope(isolate);        \
-  v8::HandleScope handle_scope(isolate);            \
-  v8::Context::Scope context_scope(context_.Get(isolate));
+  IsolateContextScope isolate_context_scope(isolate, *this);
 #endif
 
 using namespace facebook;
@@ -107,13 +115,139 @@ class TaskRunnerAdapter : public v8::TaskRunner {
 
 // String utilities
 namespace {
+// Whether data only holds 7-bit characters, in which case its UTF-8 and
+// Latin-1 interpretations agree. Checks 16 bytes at a time with SSE2 where
+// available and 8 bytes at a time otherwise; either way only the high bit of
+// each byte is looked at, folded over a whole block before testing.
+bool IsAscii(const uint8_t *data, size_t length) {
+  size_t i = 0;
+
+#ifdef V8JSI_HAS_SSE2
+  for (; i + 64 <= length; i += 64) {
+    __m128i block = _mm_or_si128(
+        _mm_or_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 16))),
+        _mm_or_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 32)),
+            _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(data + i + 48))));
+    if (_mm_movemask_epi8(block) != 0) {
+      return false;
+    }
+  }
+#endif
+
+  const uint64_t kHighBits = 0x8080808080808080ull;
+  for (; i + 32 <= length; i += 32) {
+    uint64_t words[4];
+    std::memcpy(words, data + i, sizeof(words));
+    if (((words[0] | words[1] | words[2] | words[3]) & kHighBits) != 0) {
+      return false;
+    }
+  }
+
+  uint8_t rest = 0;
+  for (; i < length; i++) {
+    rest |= data[i];
+  }
+  return (rest & 0x80) == 0;
+}
+
+// Appends the UTF-8 encoding of string to out, reusing its capacity. The
+// string is only read once: one-byte strings are copied as is and widened in
+// place if they turn out not to be ASCII, two-byte strings are copied out in
+// bounded chunks and encoded here, so out only ever has room for the worst
+// case of one chunk to spare.
+void AppendJSStringUtf8(
+    v8::Isolate *isolate,
+    v8::Local<v8::String> string,
+    std::string &out) {
+  size_t offset = out.size();
+  size_t length = static_cast<size_t>(string->Length());
+
+  if (string->IsOneByte()) {
+    out.resize(offset + length);
+    uint8_t *data = reinterpret_cast<uint8_t *>(&out[offset]);
+    string->WriteOneByte(
+        isolate,
+        data,
+        0,
+        static_cast<int>(length),
+        v8::String::NO_NULL_TERMINATION);
+    if (IsAscii(data, length)) {
+      return;
+    }
+
+    // Latin-1 characters past 0x7F take two bytes in UTF-8.
+    size_t wide = 0;
+    for (size_t i = 0; i < length; i++) {
+      wide += data[i] >> 7;
+    }
+    out.resize(offset + length + wide);
+    data = reinterpret_cast<uint8_t *>(&out[offset]);
+    for (size_t src = length, dst = length + wide; src > 0;) {
+      uint8_t c = data[--src];
+      if (c < 0x80) {
+        data[--dst] = c;
+      } else {
+        data[--dst] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+        data[--dst] = static_cast<uint8_t>(0xC0 | (c >> 6));
+      }
+    }
+    return;
+  }
+
+  // Lone surrogates take three bytes, like WriteUtf8 writes them.
+  constexpr int kChunkLength = 1024;
+  uint16_t units[kChunkLength];
+  size_t end = offset;
+  for (int start = 0, total = static_cast<int>(length); start < total;) {
+    int count = std::min(kChunkLength, total - start);
+    string->Write(
+        isolate, units, start, count, v8::String::NO_NULL_TERMINATION);
+    // A pair split by the chunk boundary is left to the next chunk.
+    if (count > 1 && start + count < total &&
+        (units[count - 1] & 0xFC00) == 0xD800) {
+      count--;
+    }
+    start += count;
+
+    // At most three bytes per UTF-16 code unit.
+    out.resize(end + 3 * static_cast<size_t>(count));
+    uint8_t *data = reinterpret_cast<uint8_t *>(&out[end]);
+    size_t dst = 0;
+    for (int i = 0; i < count; i++) {
+      uint32_t c = units[i];
+      if (c < 0x80) {
+        data[dst++] = static_cast<uint8_t>(c);
+      } else if (c < 0x800) {
+        data[dst++] = static_cast<uint8_t>(0xC0 | (c >> 6));
+        data[dst++] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+      } else if (
+          (c & 0xFC00) == 0xD800 && i + 1 < count &&
+          (units[i + 1] & 0xFC00) == 0xDC00) {
+        c = 0x10000 + ((c - 0xD800) << 10) + (units[++i] - 0xDC00);
+        data[dst++] = static_cast<uint8_t>(0xF0 | (c >> 18));
+        data[dst++] = static_cast<uint8_t>(0x80 | ((c >> 12) & 0x3F));
+        data[dst++] = static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3F));
+        data[dst++] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+      } else {
+        data[dst++] = static_cast<uint8_t>(0xE0 | (c >> 12));
+        data[dst++] = static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3F));
+        data[dst++] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+      }
+    }
+    end += dst;
+  }
+  out.resize(end);
+}
+
 std::string JSStringToSTLString(
     v8::Isolate *isolate,
     v8::Local<v8::String> string) {
-  int utfLen = string->Utf8Length(isolate);
   std::string result;
-  result.resize(utfLen);
-  string->WriteUtf8(isolate, &result[0], utfLen);
+  AppendJSStringUtf8(isolate, string, result);
   return result;
 }
 
@@ -125,11 +259,14 @@ const char *ToCString(const v8::String::Utf8Value &value) {
 
 void V8Runtime::AddHostObjectLifetimeTracker(
     std::shared_ptr<HostObjectLifetimeTracker> hostObjectLifetimeTracker) {
-  // Note that we are letting the list grow in definitely as of now.. The list
-  // gets cleaned up when the runtime is teared down.
-  // TODO :: We should remove entries from the list as the objects are garbage
-  // collected.
-  host_object_lifetime_tracker_list_.push_back(hostObjectLifetimeTracker);
+  hostObjectLifetimeTracker->position_ = host_object_lifetime_tracker_list_.insert(
+      host_object_lifetime_tracker_list_.end(), hostObjectLifetimeTracker);
+}
+
+void V8Runtime::RemoveHostObjectLifetimeTracker(
+    HostObjectLifetimeTracker *hostObjectLifetimeTracker) {
+  host_object_lifetime_tracker_list_.erase(
+      hostObjectLifetimeTracker->position_);
 }
 
 /*static */ void V8Runtime::OnMessage(
@@ -465,7 +602,7 @@ v8::Isolate *V8Runtime::CreateNewIsolate() {
       std::move(args_.foreground_task_runner));
   isolate_->SetData(
       v8runtime::ISOLATE_DATA_SLOT,
-      new v8runtime::IsolateData({foreground_task_runner_}));
+      new v8runtime::IsolateData({foreground_task_runner_, {}}));
 
   v8::Isolate::Initialize(isolate_, create_params_);
 
@@ -516,9 +653,16 @@ void V8Runtime::createHostObjectConstructorPerContext() {
       HostObjectProxy::Enumerator));
 
   // V8 distinguishes between named properties (strings and symbols) and indexed properties (number)
-  // Note that we're not passing an Enumerator here, otherwise we'd be double-counting since JSI doesn't make the distinction
-  hostObjectTemplate->SetIndexedPropertyHandler(HostObjectProxy::GetIndexed, HostObjectProxy::SetIndexed);
+  // The indexed enumerator only reports indices for IndexedHostObjects, otherwise we'd be double-counting since
+  // JSI doesn't make the distinction
+  hostObjectTemplate->SetHandler(v8::IndexedPropertyHandlerConfiguration(
+      HostObjectProxy::GetIndexed,
+      HostObjectProxy::SetIndexed,
+      nullptr,
+      nullptr,
+      HostObjectProxy::IndexedEnumerator));
   hostObjectTemplate->SetInternalFieldCount(1);
+  host_object_template_.Reset(isolate_, constructorForHostObjectTemplate);
   host_object_constructor_.Reset(
       isolate_,
       constructorForHostObjectTemplate->GetFunction(context_.Get(isolate_))
@@ -541,6 +685,15 @@ void V8Runtime::initializeV8() {
   if (args_.trackGCObjectStats)
     argv.push_back("--track_gc_object_stats");
 
+  if (args_.enableFastApiCalls)
+    argv.push_back("--turbo-fast-api-calls");
+
+  if (args_.exposeGC)
+    argv.push_back("--expose-gc");
+
+  if (args_.allowNativesSyntax)
+    argv.push_back("--allow-natives-syntax");
+
   int argc = static_cast<int>(argv.size());
   v8::V8::SetFlagsFromCommandLine(&argc, const_cast<char **>(&argv[0]), false);
 }
@@ -591,15 +744,25 @@ V8Runtime::~V8Runtime() {
   inspector_agent_.reset();
 #endif
 
+  host_object_classes_.clear();
   host_object_constructor_.Reset();
+  host_object_template_.Reset();
   context_.Reset();
 
   for (std::shared_ptr<HostObjectLifetimeTracker> hostObjectLifetimeTracker :
        host_object_lifetime_tracker_list_) {
     hostObjectLifetimeTracker->ResetHostObject(false /*isGC*/);
   }
+  host_object_lifetime_tracker_list_.clear();
+
+  // HostObjects released above may still have been holding jsi values.
+  pointer_value_table_.clear();
+  prop_name_id_cache_.reset();
+  prop_name_id_cache_size_ = 0;
 
   if (--tls_isolate_usage_counter_ == 0) {
+    // Frees the microtask queues, which must go before the isolate they are
+    // registered with.
     IsolateData* isolate_data = reinterpret_cast<IsolateData *>(isolate_->GetData(ISOLATE_DATA_SLOT));
     delete isolate_data;
 
@@ -616,23 +779,36 @@ V8Runtime::~V8Runtime() {
   // Note :: We never dispose V8 here. Is it required ?
 }
 
-jsi::Value V8Runtime::evaluateJavaScript(
-    const std::shared_ptr<const jsi::Buffer> &buffer,
-    const std::string &sourceURL) {
-  _ISOLATE_CONTEXT_ENTER
+v8::Local<v8::String> V8Runtime::CreateSourceString(
+    const std::shared_ptr<const jsi::Buffer> &buffer) {
+  v8::Local<v8::String> source;
 
-  v8::Local<v8::String> sourceV8String;
-  // If we'd somehow know the buffer includes only ASCII characters, we could use External strings to avoid the copy
-  /* ExternalOwningOneByteStringResource *external_string_resource = new ExternalOwningOneByteStringResource(buffer);
-  if (!v8::String::NewExternalOneByte(isolate, external_string_resource).ToLocal(&sourceV8String)) {
-    std::abort();
+  // An all ASCII buffer can back a one-byte external string as is, which
+  // saves transcoding the source and keeping a second copy of it on the heap.
+  if (buffer->size() >= kMinExternalSourceLength &&
+      IsAscii(buffer->data(), buffer->size())) {
+    auto resource = new ExternalOwningOneByteStringResource(buffer);
+    if (v8::String::NewExternalOneByte(isolate_, resource).ToLocal(&source)) {
+      return source;
+    }
+
+    // Only owned by V8 on success.
+    delete resource;
   }
-  delete external_string_resource; */
 
-  if (!v8::String::NewFromUtf8(isolate, reinterpret_cast<const char *>(buffer->data()),
-      v8::NewStringType::kNormal, static_cast<int>(buffer->size())).ToLocal(&sourceV8String)) {
+  if (!v8::String::NewFromUtf8(isolate_, reinterpret_cast<const char *>(buffer->data()),
+      v8::NewStringType::kNormal, static_cast<int>(buffer->size())).ToLocal(&source)) {
     std::abort();
   }
+  return source;
+}
+
+jsi::Value V8Runtime::evaluateJavaScript(
+    const std::shared_ptr<const jsi::Buffer> &buffer,
+    const std::string &sourceURL) {
+  _ISOLATE_CONTEXT_ENTER
+
+  v8::Local<v8::String> sourceV8String = CreateSourceString(buffer);
 
   jsi::Value result = ExecuteString(sourceV8String, sourceURL);
   return result;
@@ -667,7 +843,22 @@ v8::Local<v8::Context> V8Runtime::CreateContext(v8::Isolate *isolate) {
           .ToLocalChecked(),
       v8::FunctionTemplate::New(isolate, Print));
 
-  v8::Local<v8::Context> context = v8::Context::New(isolate, NULL, global);
+  std::unique_ptr<v8::MicrotaskQueue> microtaskQueue = v8::MicrotaskQueue::New(
+      isolate,
+      args_.microtasksPolicy == MicrotasksPolicy::Explicit
+          ? v8::MicrotasksPolicy::kExplicit
+          : v8::MicrotasksPolicy::kAuto);
+  microtask_queue_ = microtaskQueue.get();
+  reinterpret_cast<IsolateData *>(isolate->GetData(ISOLATE_DATA_SLOT))
+      ->microtask_queues_.push_back(std::move(microtaskQueue));
+
+  v8::Local<v8::Context> context = v8::Context::New(
+      isolate,
+      nullptr,
+      global,
+      v8::MaybeLocal<v8::Value>(),
+      v8::DeserializeInternalFieldsCallback(),
+      microtask_queue_);
   context->SetAlignedPointerInEmbedderData(1, this);
   return context;
 }
@@ -786,11 +977,7 @@ std::shared_ptr<const facebook::jsi::PreparedJavaScript>
 V8Runtime::prepareJavaScript(const std::shared_ptr<const facebook::jsi::Buffer> &buffer, std::string sourceURL) {
   _ISOLATE_CONTEXT_ENTER
   v8::TryCatch try_catch(isolate);
-  v8::Local<v8::String> source;
-  if (!v8::String::NewFromUtf8(isolate, reinterpret_cast<const char *>(buffer->data()),
-      v8::NewStringType::kNormal, static_cast<int>(buffer->size())).ToLocal(&source)) {
-    std::abort();
-  }
+  v8::Local<v8::String> source = CreateSourceString(buffer);
 
   v8::Local<v8::String> urlV8String = v8::String::NewFromUtf8(isolate, reinterpret_cast<const char *>(sourceURL.c_str())).ToLocalChecked();
   v8::ScriptOrigin origin(urlV8String);
@@ -822,11 +1009,7 @@ facebook::jsi::Value V8Runtime::evaluatePreparedJavaScript(const std::shared_ptr
   auto prepared = static_cast<const V8PreparedJavaScript*>(js.get());
 
   v8::TryCatch try_catch(isolate);
-  v8::Local<v8::String> source;
-  if (!v8::String::NewFromUtf8(isolate, reinterpret_cast<const char *>(prepared->sourceBuffer->data()),
-      v8::NewStringType::kNormal, static_cast<int>(prepared->sourceBuffer->size())).ToLocal(&source)) {
-    std::abort();
-  }
+  v8::Local<v8::String> source = CreateSourceString(prepared->sourceBuffer);
   v8::Local<v8::String> urlV8String = v8::String::NewFromUtf8(isolate, reinterpret_cast<const char *>(prepared->scriptSignature.url.c_str())).ToLocalChecked();
   v8::ScriptOrigin origin(urlV8String);
   v8::Local<v8::Context> context(isolate->GetCurrentContext());
@@ -922,7 +1105,7 @@ void V8Runtime::ReportException(v8::TryCatch *try_catch) {
 
 jsi::Object V8Runtime::global() {
   _ISOLATE_CONTEXT_ENTER
-  return make<jsi::Object>(V8ObjectValue::make(context_.Get(isolate)->Global()));
+  return make<jsi::Object>(makePointerValue(context_.Get(isolate)->Global()));
 }
 
 std::string V8Runtime::description() {
@@ -936,6 +1119,75 @@ bool V8Runtime::isInspectable() {
   return false;
 }
 
+jsi::Runtime::ScopeState *V8Runtime::pushScope() {
+  std::unique_ptr<HandleScopeState> state;
+  if (scope_state_pool_.empty()) {
+    state = std::make_unique<HandleScopeState>();
+  } else {
+    state = std::move(scope_state_pool_.back());
+    scope_state_pool_.pop_back();
+  }
+
+  state->handleScope.open(isolate_);
+  state->previous = current_scope_;
+  current_scope_ = state.get();
+  return reinterpret_cast<ScopeState *>(state.release());
+}
+
+void V8Runtime::popScope(ScopeState *scopeState) {
+  std::unique_ptr<HandleScopeState> state(
+      reinterpret_cast<HandleScopeState *>(scopeState));
+  assert(current_scope_ == state.get());
+
+  // Values that escaped the scope need a global handle before their locals
+  // go away.
+  for (V8PointerValue *pv : state->locals) {
+    pv->promote(isolate_);
+  }
+
+  state->locals.clear();
+  state->handleScope.close();
+  current_scope_ = state->previous;
+  scope_state_pool_.push_back(std::move(state));
+}
+
+void V8Runtime::enterScope() {
+  if (entered_depth_++ == 0) {
+    isolate_->Enter();
+    v8::HandleScope handle_scope(isolate_);
+    context_.Get(isolate_)->Enter();
+  }
+}
+
+bool V8Runtime::drainMicrotasks(int /*maxMicrotasksHint*/) {
+  _ISOLATE_CONTEXT_ENTER
+  // A checkpoint drains the whole queue, unless microtasks are already running
+  // further up the stack, in which case it does nothing.
+  if (microtask_queue_->IsRunningMicrotasks()) {
+    return false;
+  }
+  microtask_queue_->PerformCheckpoint(isolate);
+  return true;
+}
+
+V8RuntimeStats V8Runtime::getStats() const {
+  V8RuntimeStats stats;
+  stats.propNameIDCacheHits = prop_name_id_cache_hits_;
+  stats.propNameIDCacheMisses = prop_name_id_cache_misses_;
+  stats.propNameIDCacheSize = prop_name_id_cache_size_;
+  stats.liveHostObjectTrackers = host_object_lifetime_tracker_list_.size();
+  return stats;
+}
+
+void V8Runtime::exitScope() {
+  assert(entered_depth_ > 0);
+  if (--entered_depth_ == 0) {
+    v8::HandleScope handle_scope(isolate_);
+    context_.Get(isolate_)->Exit();
+    isolate_->Exit();
+  }
+}
+
 // Shallow clone
 jsi::Runtime::PointerValue *V8Runtime::cloneString(
     const jsi::Runtime::PointerValue *pv) {
@@ -944,8 +1196,7 @@ jsi::Runtime::PointerValue *V8Runtime::cloneString(
   }
 
   _ISOLATE_CONTEXT_ENTER
-  const V8StringValue *string = static_cast<const V8StringValue *>(pv);
-  return V8StringValue::make(string->get(GetIsolate()));
+  return makePointerValue(pvRef<v8::Value>(pv));
 }
 
 jsi::Runtime::PointerValue *V8Runtime::cloneObject(
@@ -955,8 +1206,7 @@ jsi::Runtime::PointerValue *V8Runtime::cloneObject(
   }
 
   _ISOLATE_CONTEXT_ENTER
-  const V8ObjectValue *object = static_cast<const V8ObjectValue *>(pv);
-  return V8ObjectValue::make(object->get(GetIsolate()));
+  return makePointerValue(pvRef<v8::Value>(pv));
 }
 
 jsi::Runtime::PointerValue *V8Runtime::clonePropNameID(
@@ -966,8 +1216,7 @@ jsi::Runtime::PointerValue *V8Runtime::clonePropNameID(
   }
 
   _ISOLATE_CONTEXT_ENTER
-  const V8StringValue *string = static_cast<const V8StringValue *>(pv);
-  return V8StringValue::make(string->get(GetIsolate()));
+  return makePointerValue(pvRef<v8::Value>(pv));
 }
 
 jsi::Runtime::PointerValue *V8Runtime::cloneSymbol(
@@ -977,8 +1226,7 @@ jsi::Runtime::PointerValue *V8Runtime::cloneSymbol(
   }
 
   _ISOLATE_CONTEXT_ENTER
-  const V8PointerValue<v8::Symbol>* symbol = static_cast<const V8PointerValue<v8::Symbol>*>(pv);
-  return V8PointerValue<v8::Symbol>::make(symbol->get(GetIsolate()));
+  return makePointerValue(pvRef<v8::Value>(pv));
 }
 
 std::string V8Runtime::symbolToString(const jsi::Symbol &sym) {
@@ -986,24 +1234,92 @@ std::string V8Runtime::symbolToString(const jsi::Symbol &sym) {
   return "Symbol(" + JSStringToSTLString(GetIsolate(), v8::Local<v8::String>::Cast(symbolRef(sym)->Description())) + ")";
 }
 
+v8::MaybeLocal<v8::String> V8Runtime::internPropName(
+    const char *str,
+    size_t length,
+    bool isAscii) {
+  // FNV-1a.
+  uint64_t hash = 14695981039346656037ull;
+  uint8_t highBits = 0;
+  for (size_t i = 0; i < length; i++) {
+    uint8_t c = static_cast<uint8_t>(str[i]);
+    hash = (hash ^ c) * 1099511628211ull;
+    highBits |= c;
+  }
+
+  // forAscii input past 7 bits is read as Latin-1, which would give the same
+  // bytes a different meaning than forUtf8 does. Only 7-bit names, which read
+  // the same either way, are cached.
+  if (isAscii && (highBits & 0x80)) {
+    return v8::String::NewFromOneByte(
+        GetIsolate(),
+        reinterpret_cast<const uint8_t *>(str),
+        v8::NewStringType::kInternalized,
+        static_cast<int>(length));
+  }
+
+  if (!prop_name_id_cache_) {
+    prop_name_id_cache_.reset(
+        new PropNameIDCacheEntry[kPropNameIDCacheSets * kPropNameIDCacheWays]);
+  }
+  PropNameIDCacheEntry *set = &prop_name_id_cache_
+      [(hash & (kPropNameIDCacheSets - 1)) * kPropNameIDCacheWays];
+
+  for (size_t way = 0; way < kPropNameIDCacheWays; way++) {
+    PropNameIDCacheEntry &entry = set[way];
+    if (entry.value.IsEmpty()) {
+      break;
+    }
+    if (entry.hash == hash && entry.name.size() == length &&
+        std::memcmp(entry.name.data(), str, length) == 0) {
+      ++prop_name_id_cache_hits_;
+      std::rotate(set, set + way, set + way + 1);
+      return set[0].value.Get(GetIsolate());
+    }
+  }
+
+  ++prop_name_id_cache_misses_;
+  v8::MaybeLocal<v8::String> result = isAscii
+      ? v8::String::NewFromOneByte(
+            GetIsolate(),
+            reinterpret_cast<const uint8_t *>(str),
+            v8::NewStringType::kInternalized,
+            static_cast<int>(length))
+      : v8::String::NewFromUtf8(
+            GetIsolate(),
+            str,
+            v8::NewStringType::kInternalized,
+            static_cast<int>(length));
+
+  v8::Local<v8::String> v8String;
+  if (result.ToLocal(&v8String)) {
+    // The last way is either free or the least recently used one.
+    std::rotate(
+        set, set + kPropNameIDCacheWays - 1, set + kPropNameIDCacheWays);
+    if (set[0].value.IsEmpty()) {
+      ++prop_name_id_cache_size_;
+    }
+    set[0].hash = hash;
+    set[0].name.assign(str, length);
+    set[0].value.Reset(GetIsolate(), v8String);
+  }
+
+  return result;
+}
+
 jsi::PropNameID V8Runtime::createPropNameIDFromAscii(
     const char *str,
     size_t length) {
   _ISOLATE_CONTEXT_ENTER
   v8::Local<v8::String> v8String;
-  if (!v8::String::NewFromOneByte(
-           GetIsolate(),
-           reinterpret_cast<uint8_t *>(const_cast<char *>(str)),
-           v8::NewStringType::kNormal,
-           static_cast<int>(length))
-           .ToLocal(&v8String)) {
+  if (!internPropName(str, length, true /*isAscii*/).ToLocal(&v8String)) {
     std::stringstream strstream;
     strstream << "Unable to create property id: " << str;
     throw jsi::JSError(*this, strstream.str());
   }
 
   auto res = make<jsi::PropNameID>(
-      V8StringValue::make(v8::Local<v8::String>::Cast(v8String)));
+      makePointerValue(v8String));
   return res;
 }
 
@@ -1012,11 +1328,8 @@ jsi::PropNameID V8Runtime::createPropNameIDFromUtf8(
     size_t length) {
   _ISOLATE_CONTEXT_ENTER
   v8::Local<v8::String> v8String;
-  if (!v8::String::NewFromUtf8(
-           GetIsolate(),
-           reinterpret_cast<const char *>(utf8),
-           v8::NewStringType::kNormal,
-           static_cast<int>(length))
+  if (!internPropName(
+           reinterpret_cast<const char *>(utf8), length, false /*isAscii*/)
            .ToLocal(&v8String)) {
     std::stringstream strstream;
     strstream << "Unable to create property id: " << utf8;
@@ -1024,14 +1337,14 @@ jsi::PropNameID V8Runtime::createPropNameIDFromUtf8(
   }
 
   auto res = make<jsi::PropNameID>(
-      V8StringValue::make(v8::Local<v8::String>::Cast(v8String)));
+      makePointerValue(v8String));
   return res;
 }
 
 jsi::PropNameID V8Runtime::createPropNameIDFromString(const jsi::String &str) {
   _ISOLATE_CONTEXT_ENTER
   return make<jsi::PropNameID>(
-      V8StringValue::make(v8::Local<v8::String>::Cast(stringRef(str))));
+      makePointerValue(stringRef(str)));
 }
 
 std::string V8Runtime::utf8(const jsi::PropNameID &sym) {
@@ -1042,9 +1355,13 @@ std::string V8Runtime::utf8(const jsi::PropNameID &sym) {
 
 bool V8Runtime::compare(const jsi::PropNameID &a, const jsi::PropNameID &b) {
   _ISOLATE_CONTEXT_ENTER
-  return valueRef(a)
-      ->Equals(GetIsolate()->GetCurrentContext(), valueRef(b))
-      .ToChecked();
+  v8::Local<v8::Value> aRef = valueRef(a);
+  v8::Local<v8::Value> bRef = valueRef(b);
+
+  // Names coming from the intern cache are the same internalized string, so
+  // identity settles most comparisons. StrictEquals covers names created from
+  // arbitrary jsi::Strings.
+  return aRef == bRef || aRef->StrictEquals(bRef);
 }
 
 jsi::String V8Runtime::createStringFromAscii(const char *str, size_t length) {
@@ -1064,10 +1381,379 @@ jsi::String V8Runtime::createStringFromUtf8(const uint8_t *str, size_t length) {
     throw jsi::JSError(*this, "V8 string creation failed.");
   }
 
-  jsi::String jsistr = make<jsi::String>(V8StringValue::make(v8string));
+  jsi::String jsistr = make<jsi::String>(makePointerValue(v8string));
   return jsistr;
 }
 
+// Parses straight from the UTF-8 buffer, instead of looking up JSON.parse and
+// wrapping the source in a jsi::String like the default implementation.
+jsi::Value V8Runtime::createValueFromJsonUtf8(
+    const uint8_t *json,
+    size_t length) {
+  _ISOLATE_CONTEXT_ENTER
+  if (length > static_cast<size_t>(v8::String::kMaxLength)) {
+    throw jsi::JSError(*this, "JSON source is too long.");
+  }
+
+  v8::Local<v8::String> source;
+  if (!v8::String::NewFromUtf8(
+           isolate,
+           reinterpret_cast<const char *>(json),
+           v8::NewStringType::kNormal,
+           static_cast<int>(length))
+           .ToLocal(&source)) {
+    throw jsi::JSError(*this, "V8 string creation failed.");
+  }
+
+  v8::TryCatch trycatch(isolate);
+  v8::Local<v8::Value> result;
+  if (!v8::JSON::Parse(isolate->GetCurrentContext(), source)
+           .ToLocal(&result)) {
+    if (trycatch.HasCaught()) {
+      ReportException(&trycatch);
+    }
+    throw jsi::JSError(*this, "JSON parsing failed.");
+  }
+
+  return createValue(result);
+}
+
+// V8 stores the string as one-byte on its own when all code units fit, so
+// Latin-1 text stays compact without a check here.
+jsi::String V8Runtime::createStringFromUtf16(
+    const char16_t *utf16,
+    size_t length) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::String> v8string;
+  if (length > static_cast<size_t>(v8::String::kMaxLength) ||
+      !v8::String::NewFromTwoByte(
+           isolate,
+           reinterpret_cast<const uint16_t *>(utf16),
+           v8::NewStringType::kNormal,
+           static_cast<int>(length))
+           .ToLocal(&v8string)) {
+    throw jsi::JSError(*this, "V8 string creation failed.");
+  }
+
+  return make<jsi::String>(makePointerValue(v8string));
+}
+
+void V8Runtime::appendUtf16(const jsi::String &str, std::u16string &out) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::String> string = stringRef(str);
+  int length = string->Length();
+  size_t offset = out.size();
+  out.resize(offset + length);
+  string->Write(
+      isolate,
+      reinterpret_cast<uint16_t *>(&out[offset]),
+      0,
+      length,
+      v8::String::NO_NULL_TERMINATION);
+}
+
+void V8Runtime::appendUtf8(const jsi::String &str, std::string &out) {
+  _ISOLATE_CONTEXT_ENTER
+  AppendJSStringUtf8(isolate, stringRef(str), out);
+}
+
+void V8Runtime::appendUtf8(const jsi::PropNameID &name, std::string &out) {
+  _ISOLATE_CONTEXT_ENTER
+  AppendJSStringUtf8(isolate, valueRef(name).As<v8::String>(), out);
+}
+
+bool V8Runtime::stringifyJsonUtf8(const jsi::Value &value, std::string &json) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::TryCatch trycatch(isolate);
+  v8::Local<v8::String> result;
+  if (!v8::JSON::Stringify(isolate->GetCurrentContext(), valueRef(value))
+           .ToLocal(&result)) {
+    if (trycatch.HasCaught()) {
+      ReportException(&trycatch);
+    }
+    throw jsi::JSError(*this, "JSON serialization failed.");
+  }
+
+  // Where JSON.stringify returns undefined (functions, symbols, undefined),
+  // v8::JSON::Stringify gives the string "undefined", which is never valid
+  // JSON text otherwise.
+  if (result->Length() == 9 &&
+      result->StringEquals(
+          v8::String::NewFromOneByte(
+              isolate, reinterpret_cast<const uint8_t *>("undefined"))
+              .ToLocalChecked())) {
+    return false;
+  }
+
+  AppendJSStringUtf8(isolate, result, json);
+  return true;
+}
+
+// Walks a V8 value for visitValueTree. Strings are written to a reused
+// scratch buffer rather than going through jsi::String::utf8.
+class V8Runtime::ValueTreeReader {
+ public:
+  ValueTreeReader(
+      V8Runtime &runtime,
+      v8::Local<v8::Context> context,
+      v8::TryCatch &trycatch,
+      ValueTreeVisitor &visitor)
+      : runtime_(runtime),
+        isolate_(context->GetIsolate()),
+        context_(context),
+        trycatch_(trycatch),
+        visitor_(visitor) {}
+
+  void visit(v8::Local<v8::Value> value) {
+    if (value->IsUndefined() || value->IsNull()) {
+      visitor_.null();
+    } else if (value->IsBoolean()) {
+      visitor_.boolean(value.As<v8::Boolean>()->Value());
+    } else if (value->IsNumber()) {
+      visitor_.number(value.As<v8::Number>()->Value());
+    } else if (value->IsString()) {
+      toUtf8(value.As<v8::String>());
+      visitor_.string(scratch_.data(), scratch_.size());
+    } else if (value->IsArray()) {
+      visitArray(value.As<v8::Array>());
+    } else if (value->IsFunction()) {
+      throw jsi::JSError(
+          runtime_, "JS Functions are not convertible to dynamic");
+    } else if (value->IsObject()) {
+      visitObject(value.As<v8::Object>());
+    } else {
+      throw jsi::JSError(runtime_, "JS Symbols are not convertible to dynamic");
+    }
+  }
+
+ private:
+  void visitArray(v8::Local<v8::Array> array) {
+    uint32_t length = array->Length();
+    visitor_.beginArray(length);
+    for (uint32_t i = 0; i < length; i++) {
+      v8::HandleScope element_scope(isolate_);
+      visit(get(array->Get(context_, i)));
+    }
+    visitor_.endArray();
+  }
+
+  void visitObject(v8::Local<v8::Object> object) {
+    // Same keys as V8Runtime::getPropertyNames.
+    v8::Local<v8::Array> names = get(object->GetPropertyNames(
+        context_,
+        v8::KeyCollectionMode::kIncludePrototypes,
+        static_cast<v8::PropertyFilter>(
+            v8::ONLY_ENUMERABLE | v8::SKIP_SYMBOLS),
+        v8::IndexFilter::kIncludeIndices,
+        v8::KeyConversionMode::kConvertToString));
+
+    visitor_.beginObject();
+    uint32_t length = names->Length();
+    for (uint32_t i = 0; i < length; i++) {
+      v8::HandleScope property_scope(isolate_);
+      v8::Local<v8::String> name =
+          get(names->Get(context_, i)).As<v8::String>();
+      v8::Local<v8::Value> value = get(object->Get(context_, name));
+      if (value->IsUndefined()) {
+        continue;
+      }
+
+      toUtf8(name);
+      visitor_.key(scratch_.data(), scratch_.size());
+
+      // Like the JSON.stringify based conversions, a function property turns
+      // into null.
+      if (value->IsFunction()) {
+        visitor_.null();
+      } else {
+        visit(value);
+      }
+    }
+    visitor_.endObject();
+  }
+
+  template <typename T>
+  v8::Local<T> get(v8::MaybeLocal<T> maybe) {
+    v8::Local<T> result;
+    if (!maybe.ToLocal(&result)) {
+      if (trycatch_.HasCaught()) {
+        runtime_.ReportException(&trycatch_);
+      }
+      throw jsi::JSError(runtime_, "Reading the value tree failed.");
+    }
+    return result;
+  }
+
+  void toUtf8(v8::Local<v8::String> string) {
+    scratch_.clear();
+    AppendJSStringUtf8(isolate_, string, scratch_);
+  }
+
+  V8Runtime &runtime_;
+  v8::Isolate *isolate_;
+  v8::Local<v8::Context> context_;
+  v8::TryCatch &trycatch_;
+  ValueTreeVisitor &visitor_;
+  std::string scratch_;
+};
+
+// Builds V8 values for buildValueTree. Containers are attached to their
+// parent when they begin, so the stack only tracks where the next value goes.
+class V8Runtime::ValueTreeBuilder final : public ValueTreeVisitor {
+ public:
+  ValueTreeBuilder(
+      V8Runtime &runtime,
+      v8::Local<v8::Context> context,
+      v8::TryCatch &trycatch)
+      : runtime_(runtime),
+        isolate_(context->GetIsolate()),
+        context_(context),
+        trycatch_(trycatch) {}
+
+  void null() override {
+    add(v8::Null(isolate_));
+  }
+
+  void boolean(bool value) override {
+    add(v8::Boolean::New(isolate_, value));
+  }
+
+  void number(double value) override {
+    add(v8::Number::New(isolate_, value));
+  }
+
+  void string(const char *utf8, size_t length) override {
+    add(newString(utf8, length, v8::NewStringType::kNormal));
+  }
+
+  void beginArray(size_t length) override {
+    v8::Local<v8::Array> array =
+        v8::Array::New(isolate_, static_cast<int>(length));
+    add(array);
+    stack_.push_back({array, true, 0, v8::Local<v8::String>()});
+  }
+
+  void endArray() override {
+    if (stack_.empty() || !stack_.back().isArray) {
+      throw jsi::JSINativeException("ValueTreeVisitor: unmatched endArray");
+    }
+    stack_.pop_back();
+  }
+
+  void beginObject() override {
+    v8::Local<v8::Object> object = v8::Object::New(isolate_);
+    add(object);
+    stack_.push_back({object, false, 0, v8::Local<v8::String>()});
+  }
+
+  void key(const char *utf8, size_t length) override {
+    if (stack_.empty() || stack_.back().isArray ||
+        !stack_.back().key.IsEmpty()) {
+      throw jsi::JSINativeException("ValueTreeVisitor: unexpected key");
+    }
+    // Internalized, so that V8's string table shares the keys repeated across
+    // the tree, but not through internPropName: the keys of arbitrary data
+    // would evict the names the host looks up from the PropNameID cache.
+    stack_.back().key =
+        newString(utf8, length, v8::NewStringType::kInternalized);
+  }
+
+  void endObject() override {
+    if (stack_.empty() || stack_.back().isArray ||
+        !stack_.back().key.IsEmpty()) {
+      throw jsi::JSINativeException("ValueTreeVisitor: unmatched endObject");
+    }
+    stack_.pop_back();
+  }
+
+  v8::Local<v8::Value> result() const {
+    if (result_.IsEmpty() || !stack_.empty()) {
+      throw jsi::JSINativeException("ValueTreeVisitor: incomplete value");
+    }
+    return result_;
+  }
+
+ private:
+  struct Container {
+    v8::Local<v8::Object> object;
+    bool isArray;
+    uint32_t index{0};
+    v8::Local<v8::String> key;
+  };
+
+  v8::Local<v8::String> newString(
+      const char *utf8,
+      size_t length,
+      v8::NewStringType type) {
+    v8::Local<v8::String> value;
+    if (!v8::String::NewFromUtf8(
+             isolate_, utf8, type, static_cast<int>(length))
+             .ToLocal(&value)) {
+      throw jsi::JSError(runtime_, "V8 string creation failed.");
+    }
+    return value;
+  }
+
+  void add(v8::Local<v8::Value> value) {
+    if (stack_.empty()) {
+      if (!result_.IsEmpty()) {
+        throw jsi::JSINativeException("ValueTreeVisitor: more than one root");
+      }
+      result_ = value;
+      return;
+    }
+
+    // Set rather than CreateDataProperty, like setProperty and
+    // setValueAtIndex would.
+    Container &container = stack_.back();
+    v8::Maybe<bool> set = v8::Nothing<bool>();
+    if (container.isArray) {
+      set = container.object->Set(context_, container.index++, value);
+    } else if (!container.key.IsEmpty()) {
+      set = container.object->Set(context_, container.key, value);
+      container.key.Clear();
+    } else {
+      throw jsi::JSINativeException("ValueTreeVisitor: missing key");
+    }
+
+    if (set.IsNothing()) {
+      if (trycatch_.HasCaught()) {
+        runtime_.ReportException(&trycatch_);
+      }
+      throw jsi::JSError(runtime_, "Building the value tree failed.");
+    }
+  }
+
+  V8Runtime &runtime_;
+  v8::Isolate *isolate_;
+  v8::Local<v8::Context> context_;
+  v8::TryCatch &trycatch_;
+  std::vector<Container> stack_;
+  v8::Local<v8::Value> result_;
+};
+
+void V8Runtime::visitValueTree(
+    const jsi::Value &value,
+    ValueTreeVisitor &visitor) {
+  _ISOLATE_CONTEXT_ENTER
+  // The visitor may call back into the runtime from within the reader's
+  // nested HandleScopes.
+  ScopeSuspension suspension(*this);
+  v8::TryCatch trycatch(isolate);
+  ValueTreeReader reader(
+      *this, isolate->GetCurrentContext(), trycatch, visitor);
+  reader.visit(valueRef(value));
+}
+
+jsi::Value V8Runtime::buildValueTree(
+    const std::function<void(ValueTreeVisitor &)> &produce) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::TryCatch trycatch(isolate);
+  ValueTreeBuilder builder(*this, isolate->GetCurrentContext(), trycatch);
+  produce(builder);
+  return createValue(builder.result());
+}
+
 std::string V8Runtime::utf8(const jsi::String &str) {
   _ISOLATE_CONTEXT_ENTER
   return JSStringToSTLString(GetIsolate(), stringRef(str));
@@ -1075,16 +1761,129 @@ std::string V8Runtime::utf8(const jsi::String &str) {
 
 jsi::Object V8Runtime::createObject() {
   _ISOLATE_CONTEXT_ENTER
-  return make<jsi::Object>(V8ObjectValue::make(v8::Object::New(GetIsolate())));
+  return make<jsi::Object>(makePointerValue(v8::Object::New(GetIsolate())));
 }
 
 jsi::Object V8Runtime::createObject(
     std::shared_ptr<jsi::HostObject> hostobject) {
   _ISOLATE_CONTEXT_ENTER
-  HostObjectProxy *hostObjectProxy = new HostObjectProxy(*this, hostobject);
+  return createHostObject(
+      std::move(hostobject), nullptr, host_object_constructor_.Get(isolate));
+}
+
+jsi::Object V8Runtime::createIndexedHostObject(
+    std::shared_ptr<IndexedHostObject> hostObject) {
+  _ISOLATE_CONTEXT_ENTER
+  IndexedHostObject *indexedHostObject = hostObject.get();
+  return createHostObject(
+      std::move(hostObject),
+      indexedHostObject,
+      host_object_constructor_.Get(isolate));
+}
+
+HostObjectClass *V8Runtime::createHostObjectClass(
+    HostObjectClassDescription &&description) {
+  _ISOLATE_CONTEXT_ENTER
+  auto hostObjectClass =
+      std::make_unique<HostObjectClass>(std::move(description));
+  const HostObjectClassDescription &desc = hostObjectClass->description;
+
+  auto newName = [isolate](const std::string &name) {
+    return v8::String::NewFromUtf8(
+               isolate,
+               name.data(),
+               v8::NewStringType::kInternalized,
+               static_cast<int>(name.size()))
+        .ToLocalChecked();
+  };
+
+  // No interceptors: the instances only carry the HostObjectProxy. Inheriting
+  // from the host object template keeps isHostObject working for them.
+  v8::Local<v8::FunctionTemplate> classTemplate =
+      v8::FunctionTemplate::New(isolate);
+  classTemplate->Inherit(host_object_template_.Get(isolate));
+  classTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+  if (!desc.className.empty()) {
+    classTemplate->SetClassName(newName(desc.className));
+  }
+
+  // The accessors and methods can be called on other receivers through the
+  // prototype, which the signature rejects with a TypeError.
+  v8::Local<v8::Signature> signature =
+      v8::Signature::New(isolate, classTemplate);
+  v8::Local<v8::ObjectTemplate> prototypeTemplate =
+      classTemplate->PrototypeTemplate();
+
+  for (const HostObjectClassDescription::Property &property :
+       desc.properties) {
+    v8::Local<v8::External> data = v8::External::New(
+        isolate, const_cast<HostObjectClassDescription::Property *>(&property));
+    v8::Local<v8::FunctionTemplate> getter = v8::FunctionTemplate::New(
+        isolate,
+        HostObjectProxy::ClassGetter,
+        data,
+        signature,
+        0,
+        v8::ConstructorBehavior::kThrow);
+    v8::Local<v8::FunctionTemplate> setter;
+    if (property.set) {
+      setter = v8::FunctionTemplate::New(
+          isolate,
+          HostObjectProxy::ClassSetter,
+          data,
+          signature,
+          1,
+          v8::ConstructorBehavior::kThrow);
+    }
+    prototypeTemplate->SetAccessorProperty(
+        newName(property.name), getter, setter);
+  }
+
+  for (const HostObjectClassDescription::Function &method : desc.methods) {
+    v8::Local<v8::External> data = v8::External::New(
+        isolate, const_cast<HostObjectClassDescription::Function *>(&method));
+    prototypeTemplate->Set(
+        newName(method.name),
+        v8::FunctionTemplate::New(
+            isolate,
+            HostObjectProxy::ClassMethod,
+            data,
+            signature,
+            static_cast<int>(method.paramCount),
+            v8::ConstructorBehavior::kThrow),
+        v8::DontEnum);
+  }
+
+  v8::Local<v8::Function> constructor;
+  if (!classTemplate->GetFunction(isolate->GetCurrentContext())
+           .ToLocal(&constructor)) {
+    throw jsi::JSError(*this, "V8Runtime::createHostObjectClass failed.");
+  }
+  hostObjectClass->constructor.Reset(isolate, constructor);
+
+  host_object_classes_.push_back(std::move(hostObjectClass));
+  return host_object_classes_.back().get();
+}
+
+jsi::Object V8Runtime::createHostObject(
+    HostObjectClass *hostObjectClass,
+    std::shared_ptr<jsi::HostObject> hostObject) {
+  _ISOLATE_CONTEXT_ENTER
+  return createHostObject(
+      std::move(hostObject),
+      nullptr,
+      hostObjectClass->constructor.Get(isolate));
+}
+
+jsi::Object V8Runtime::createHostObject(
+    std::shared_ptr<jsi::HostObject> hostobject,
+    IndexedHostObject *indexedHostObject,
+    v8::Local<v8::Function> constructor) {
+  _ISOLATE_CONTEXT_ENTER
+  HostObjectProxy *hostObjectProxy =
+      new HostObjectProxy(*this, hostobject, indexedHostObject);
   v8::Local<v8::Object> newObject;
-  if (!host_object_constructor_.Get(isolate_)
-           ->NewInstance(isolate_->GetCurrentContext())
+  if (!constructor->NewInstance(isolate_->GetCurrentContext())
            .ToLocal(&newObject)) {
     throw jsi::JSError(*this, "HostObject construction failed!!");
   }
@@ -1097,7 +1896,7 @@ jsi::Object V8Runtime::createObject(
   AddHostObjectLifetimeTracker(std::make_shared<HostObjectLifetimeTracker>(
       *this, newObject, hostObjectProxy));
 
-  return make<jsi::Object>(V8ObjectValue::make(newObject));
+  return make<jsi::Object>(makePointerValue(newObject));
 }
 
 std::shared_ptr<jsi::HostObject> V8Runtime::getHostObject(
@@ -1130,6 +1929,49 @@ jsi::Value V8Runtime::getProperty(
   return createValue(result.ToLocalChecked());
 }
 
+void V8Runtime::getProperties(
+    const jsi::Object &obj,
+    const jsi::PropNameID *names,
+    size_t count,
+    jsi::Value *values) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Object> object = objectRef(obj);
+  v8::TryCatch trycatch(isolate);
+
+  for (size_t i = 0; i < count; i++) {
+    v8::Local<v8::Value> value;
+    if (!object->Get(context, valueRef(names[i])).ToLocal(&value)) {
+      if (trycatch.HasCaught()) {
+        ReportException(&trycatch);
+      }
+      throw jsi::JSError(*this, "V8Runtime::getProperty failed.");
+    }
+    values[i] = createValue(value);
+  }
+}
+
+void V8Runtime::setProperties(
+    jsi::Object &obj,
+    const jsi::PropNameID *names,
+    const jsi::Value *values,
+    size_t count) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Object> object = objectRef(obj);
+  v8::TryCatch trycatch(isolate);
+
+  for (size_t i = 0; i < count; i++) {
+    if (!object->Set(context, valueRef(names[i]), valueRef(values[i]))
+             .FromMaybe(false)) {
+      if (trycatch.HasCaught()) {
+        ReportException(&trycatch);
+      }
+      throw jsi::JSError(*this, "V8Runtime::setPropertyValue failed.");
+    }
+  }
+}
+
 bool V8Runtime::hasProperty(const jsi::Object &obj, const jsi::String &name) {
   _ISOLATE_CONTEXT_ENTER
   v8::Maybe<bool> result =
@@ -1177,16 +2019,210 @@ bool V8Runtime::isArray(const jsi::Object &obj) const {
   return objectRef(obj)->IsArray();
 }
 
-bool V8Runtime::isArrayBuffer(const jsi::Object & /*obj*/) const {
-  throw std::runtime_error("Unsupported");
+bool V8Runtime::isArrayBuffer(const jsi::Object &obj) const {
+  _ISOLATE_CONTEXT_ENTER
+  return objectRef(obj)->IsArrayBuffer();
 }
 
+// The returned pointer is the backing store itself, so writes are visible to
+// JS. It stays valid for as long as the ArrayBuffer isn't detached.
 uint8_t *V8Runtime::data(const jsi::ArrayBuffer &obj) {
-  throw std::runtime_error("Unsupported");
+  _ISOLATE_CONTEXT_ENTER
+  return static_cast<uint8_t *>(
+      objectRef(obj).As<v8::ArrayBuffer>()->GetBackingStore()->Data());
+}
+
+size_t V8Runtime::size(const jsi::ArrayBuffer &obj) {
+  _ISOLATE_CONTEXT_ENTER
+  return objectRef(obj).As<v8::ArrayBuffer>()->ByteLength();
+}
+
+jsi::ArrayBuffer V8Runtime::createExternalArrayBuffer(
+    uint8_t *data,
+    size_t size,
+    std::function<void(uint8_t *)> deleter) {
+  _ISOLATE_CONTEXT_ENTER
+  // Owned by the backing store and freed by its deleter callback, which V8
+  // may run on any thread once the last ArrayBuffer using it is gone.
+  auto deleterData = new std::function<void(uint8_t *)>(std::move(deleter));
+  std::unique_ptr<v8::BackingStore> backingStore =
+      v8::ArrayBuffer::NewBackingStore(
+          data,
+          size,
+          [](void *data, size_t /*length*/, void *deleterData) {
+            auto deleter =
+                static_cast<std::function<void(uint8_t *)> *>(deleterData);
+            if (*deleter)
+              (*deleter)(static_cast<uint8_t *>(data));
+            delete deleter;
+          },
+          deleterData);
+
+  v8::Local<v8::ArrayBuffer> arrayBuffer =
+      v8::ArrayBuffer::New(isolate, std::move(backingStore));
+  return make<jsi::Object>(makePointerValue(arrayBuffer))
+      .getArrayBuffer(*this);
+}
+
+namespace {
+
+size_t TypedArrayElementSize(TypedArrayKind kind) {
+  switch (kind) {
+    case TypedArrayKind::Int8Array:
+    case TypedArrayKind::Uint8Array:
+    case TypedArrayKind::Uint8ClampedArray:
+      return 1;
+    case TypedArrayKind::Int16Array:
+    case TypedArrayKind::Uint16Array:
+      return 2;
+    case TypedArrayKind::Int32Array:
+    case TypedArrayKind::Uint32Array:
+    case TypedArrayKind::Float32Array:
+      return 4;
+    case TypedArrayKind::Float64Array:
+    case TypedArrayKind::BigInt64Array:
+    case TypedArrayKind::BigUint64Array:
+      return 8;
+  }
+  throw jsi::JSINativeException("Unknown TypedArrayKind");
+}
+
+v8::Local<v8::TypedArray> NewTypedArray(
+    TypedArrayKind kind,
+    v8::Local<v8::ArrayBuffer> buffer,
+    size_t byteOffset,
+    size_t length) {
+  switch (kind) {
+    case TypedArrayKind::Int8Array:
+      return v8::Int8Array::New(buffer, byteOffset, length);
+    case TypedArrayKind::Uint8Array:
+      return v8::Uint8Array::New(buffer, byteOffset, length);
+    case TypedArrayKind::Uint8ClampedArray:
+      return v8::Uint8ClampedArray::New(buffer, byteOffset, length);
+    case TypedArrayKind::Int16Array:
+      return v8::Int16Array::New(buffer, byteOffset, length);
+    case TypedArrayKind::Uint16Array:
+      return v8::Uint16Array::New(buffer, byteOffset, length);
+    case TypedArrayKind::Int32Array:
+      return v8::Int32Array::New(buffer, byteOffset, length);
+    case TypedArrayKind::Uint32Array:
+      return v8::Uint32Array::New(buffer, byteOffset, length);
+    case TypedArrayKind::Float32Array:
+      return v8::Float32Array::New(buffer, byteOffset, length);
+    case TypedArrayKind::Float64Array:
+      return v8::Float64Array::New(buffer, byteOffset, length);
+    case TypedArrayKind::BigInt64Array:
+      return v8::BigInt64Array::New(buffer, byteOffset, length);
+    case TypedArrayKind::BigUint64Array:
+      return v8::BigUint64Array::New(buffer, byteOffset, length);
+  }
+  throw jsi::JSINativeException("Unknown TypedArrayKind");
+}
+
+bool GetTypedArrayKind(v8::Local<v8::Value> value, TypedArrayKind &kind) {
+  if (value->IsInt8Array())
+    kind = TypedArrayKind::Int8Array;
+  else if (value->IsUint8Array())
+    kind = TypedArrayKind::Uint8Array;
+  else if (value->IsUint8ClampedArray())
+    kind = TypedArrayKind::Uint8ClampedArray;
+  else if (value->IsInt16Array())
+    kind = TypedArrayKind::Int16Array;
+  else if (value->IsUint16Array())
+    kind = TypedArrayKind::Uint16Array;
+  else if (value->IsInt32Array())
+    kind = TypedArrayKind::Int32Array;
+  else if (value->IsUint32Array())
+    kind = TypedArrayKind::Uint32Array;
+  else if (value->IsFloat32Array())
+    kind = TypedArrayKind::Float32Array;
+  else if (value->IsFloat64Array())
+    kind = TypedArrayKind::Float64Array;
+  else if (value->IsBigInt64Array())
+    kind = TypedArrayKind::BigInt64Array;
+  else if (value->IsBigUint64Array())
+    kind = TypedArrayKind::BigUint64Array;
+  else
+    return false;
+  return true;
+}
+
+} // namespace
+
+jsi::Object V8Runtime::createTypedArray(
+    TypedArrayKind kind,
+    const jsi::ArrayBuffer &buffer,
+    size_t byteOffset,
+    size_t length) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::ArrayBuffer> arrayBuffer =
+      objectRef(buffer).As<v8::ArrayBuffer>();
+
+  // V8 only DCHECKs the view's bounds.
+  size_t elementSize = TypedArrayElementSize(kind);
+  size_t byteLength = arrayBuffer->ByteLength();
+  if (byteOffset % elementSize != 0 || byteOffset > byteLength ||
+      length > (byteLength - byteOffset) / elementSize) {
+    throw jsi::JSINativeException(
+        "V8Runtime::createTypedArray: view out of the buffer's bounds");
+  }
+
+  return make<jsi::Object>(
+      makePointerValue(NewTypedArray(kind, arrayBuffer, byteOffset, length)));
+}
+
+jsi::Object V8Runtime::createTypedArray(
+    TypedArrayKind kind,
+    const void *data,
+    size_t length) {
+  _ISOLATE_CONTEXT_ENTER
+  size_t elementSize = TypedArrayElementSize(kind);
+  if (length > v8::TypedArray::kMaxLength || length > SIZE_MAX / elementSize) {
+    throw jsi::JSINativeException(
+        "V8Runtime::createTypedArray: length too large");
+  }
+
+  size_t byteLength = length * elementSize;
+  v8::Local<v8::ArrayBuffer> arrayBuffer =
+      v8::ArrayBuffer::New(isolate, byteLength);
+  if (data && byteLength > 0) {
+    std::memcpy(arrayBuffer->GetBackingStore()->Data(), data, byteLength);
+  }
+
+  return make<jsi::Object>(
+      makePointerValue(NewTypedArray(kind, arrayBuffer, 0, length)));
+}
+
+bool V8Runtime::getTypedArrayData(
+    const jsi::Object &obj,
+    TypedArrayData &out) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::Object> object = objectRef(obj);
+  if (!GetTypedArrayKind(object, out.kind)) {
+    return false;
+  }
+
+  // Buffer() moves the elements of small on-heap typed arrays off the heap,
+  // so the pointer stays stable for as long as the buffer is attached.
+  v8::Local<v8::TypedArray> typedArray = object.As<v8::TypedArray>();
+  uint8_t *base = static_cast<uint8_t *>(
+      typedArray->Buffer()->GetBackingStore()->Data());
+  out.length = typedArray->Length();
+  out.byteLength = typedArray->ByteLength();
+  out.data = base ? base + typedArray->ByteOffset() : nullptr;
+  return true;
 }
 
-size_t V8Runtime::size(const jsi::ArrayBuffer & /*obj*/) {
-  throw std::runtime_error("Unsupported");
+jsi::ArrayBuffer V8Runtime::createArrayBuffer(
+    const uint8_t *data,
+    size_t size) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::ArrayBuffer> arrayBuffer = v8::ArrayBuffer::New(isolate, size);
+  if (size > 0) {
+    std::memcpy(arrayBuffer->GetBackingStore()->Data(), data, size);
+  }
+  return make<jsi::Object>(makePointerValue(arrayBuffer))
+      .getArrayBuffer(*this);
 }
 
 bool V8Runtime::isFunction(const jsi::Object &obj) const {
@@ -1196,30 +2232,21 @@ bool V8Runtime::isFunction(const jsi::Object &obj) const {
 
 bool V8Runtime::isHostObject(const jsi::Object &obj) const {
   _ISOLATE_CONTEXT_ENTER
-  if (objectRef(obj)->InternalFieldCount() < 1) {
+  v8::Local<v8::Object> object = objectRef(obj);
+
+  // Host objects are exactly the instances of this runtime's host object
+  // template.
+  if (!host_object_template_.Get(isolate)->HasInstance(object)) {
     return false;
   }
 
-  auto internalFieldRef = objectRef(obj)->GetInternalField(0);
+  auto internalFieldRef = object->GetInternalField(0);
   if (internalFieldRef.IsEmpty()) {
     return false;
   }
 
   v8::Local<v8::External> internalField = v8::Local<v8::External>::Cast(internalFieldRef);
-  if (!internalField->Value()) {
-    return false;
-  }
-
-  HostObjectProxy *hostObjectProxy = reinterpret_cast<HostObjectProxy *>(internalField->Value());
-
-  for (const std::shared_ptr<HostObjectLifetimeTracker>& hostObjectLifetimeTracker :
-       host_object_lifetime_tracker_list_) {
-    if (hostObjectLifetimeTracker->IsEqual(hostObjectProxy)) {
-      return true;
-    }
-  }
-
-  return false;
+  return internalField->Value() != nullptr;
 }
 
 // Very expensive
@@ -1232,23 +2259,123 @@ jsi::Array V8Runtime::getPropertyNames(const jsi::Object &obj) {
               static_cast<v8::PropertyFilter>(v8::ONLY_ENUMERABLE | v8::SKIP_SYMBOLS),
               v8::IndexFilter::kIncludeIndices,
               v8::KeyConversionMode::kConvertToString).ToLocalChecked();
-  return make<jsi::Object>(V8ObjectValue::make(propNames)).getArray(*this);
+  return make<jsi::Object>(makePointerValue(propNames)).getArray(*this);
+}
+
+void V8Runtime::getOwnProperties(
+    const jsi::Object &obj,
+    std::vector<jsi::PropNameID> &names,
+    std::vector<jsi::Value> &values) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Object> object = objectRef(obj);
+  v8::TryCatch trycatch(isolate);
+
+  v8::Local<v8::Array> keys;
+  if (!object
+           ->GetOwnPropertyNames(
+               context,
+               static_cast<v8::PropertyFilter>(
+                   v8::ONLY_ENUMERABLE | v8::SKIP_SYMBOLS),
+               v8::KeyConversionMode::kConvertToString)
+           .ToLocal(&keys)) {
+    if (trycatch.HasCaught()) {
+      ReportException(&trycatch);
+    }
+    throw jsi::JSError(*this, "V8Runtime::getOwnProperties failed.");
+  }
+
+  uint32_t length = keys->Length();
+  names.clear();
+  values.clear();
+  names.reserve(length);
+  values.reserve(length);
+
+  // The values are created in the per property HandleScopes below.
+  ScopeSuspension suspension(*this);
+  for (uint32_t i = 0; i < length; i++) {
+    // Scoped per property, as an object may have many of them.
+    v8::HandleScope property_scope(isolate);
+    v8::Local<v8::Value> key;
+    v8::Local<v8::Value> value;
+    if (!keys->Get(context, i).ToLocal(&key) ||
+        !object->Get(context, key).ToLocal(&value)) {
+      if (trycatch.HasCaught()) {
+        ReportException(&trycatch);
+      }
+      throw jsi::JSError(*this, "V8Runtime::getOwnProperties failed.");
+    }
+
+    names.push_back(make<jsi::PropNameID>(makePointerValue(key)));
+    values.push_back(createValue(value));
+  }
 }
 
-jsi::WeakObject V8Runtime::createWeakObject(const jsi::Object &) {
-  throw std::logic_error("Not implemented");
+jsi::WeakObject V8Runtime::createWeakObject(const jsi::Object &obj) {
+  _ISOLATE_CONTEXT_ENTER
+  V8PointerValue *pv = pointer_value_table_.allocate(isolate, objectRef(obj));
+  pv->makeWeak();
+  return make<jsi::WeakObject>(pv);
 }
 
-jsi::Value V8Runtime::lockWeakObject(jsi::WeakObject &) {
-  throw std::logic_error("Not implemented");
+jsi::Value V8Runtime::lockWeakObject(jsi::WeakObject &weakObj) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::Value> object = pvRef<v8::Value>(getPointerValue(weakObj));
+  if (object.IsEmpty()) {
+    return jsi::Value();
+  }
+
+  return createValue(object);
 }
 
 jsi::Array V8Runtime::createArray(size_t length) {
   _ISOLATE_CONTEXT_ENTER
-  return make<jsi::Object>(V8ObjectValue::make(v8::Array::New(GetIsolate(), static_cast<int>(length))))
+  return make<jsi::Object>(makePointerValue(v8::Array::New(GetIsolate(), static_cast<int>(length))))
+      .getArray(*this);
+}
+
+jsi::Array V8Runtime::createArrayFromValues(
+    const jsi::Value *values,
+    size_t count) {
+  _ISOLATE_CONTEXT_ENTER
+  CallArguments elements(*this, values, count);
+  return make<jsi::Object>(
+             makePointerValue(v8::Array::New(isolate, elements.data(), count)))
       .getArray(*this);
 }
 
+void V8Runtime::getArrayValues(
+    const jsi::Array &arr,
+    std::vector<jsi::Value> &values,
+    size_t start,
+    size_t count) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(objectRef(arr));
+  v8::TryCatch trycatch(isolate);
+
+  size_t length = array->Length();
+  size_t end = start < length ? start + std::min(count, length - start) : start;
+  values.clear();
+  values.reserve(end - start);
+
+  // The values are created in the per element HandleScopes below.
+  ScopeSuspension suspension(*this);
+  for (size_t i = start; i < end; i++) {
+    // Scoped per element, as an array may have many of them.
+    v8::HandleScope element_scope(isolate);
+    v8::Local<v8::Value> value;
+    if (!array->Get(context, static_cast<uint32_t>(i)).ToLocal(&value)) {
+      if (trycatch.HasCaught()) {
+        ReportException(&trycatch);
+      }
+      throw jsi::JSError(*this, "V8Runtime::getArrayValues failed.");
+    }
+
+    values.push_back(createValue(value));
+  }
+}
+
 size_t V8Runtime::size(const jsi::Array &arr) {
   _ISOLATE_CONTEXT_ENTER
   v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(objectRef(arr));
@@ -1295,7 +2422,108 @@ jsi::Function V8Runtime::createFunctionFromHostFunction(
   AddHostObjectLifetimeTracker(std::make_shared<HostObjectLifetimeTracker>(
       *this, newFunction, hostFunctionProxy));
 
-  return make<jsi::Object>(V8ObjectValue::make(newFunction)).getFunction(*this);
+  return make<jsi::Object>(makePointerValue(newFunction)).getFunction(*this);
+}
+
+namespace {
+
+// V8 implements a resolver as the promise itself, so that is all there is to
+// check.
+v8::Local<v8::Promise::Resolver> AsPromiseResolver(
+    v8::Local<v8::Object> object) {
+  if (!object->IsPromise()) {
+    throw jsi::JSINativeException("Object is not a promise resolver");
+  }
+  return object.As<v8::Promise::Resolver>();
+}
+
+} // namespace
+
+jsi::Object V8Runtime::createPromiseResolver() {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::Promise::Resolver> resolver;
+  if (!v8::Promise::Resolver::New(isolate->GetCurrentContext())
+           .ToLocal(&resolver)) {
+    throw jsi::JSError(*this, "V8Runtime::createPromiseResolver failed.");
+  }
+
+  return make<jsi::Object>(makePointerValue(resolver));
+}
+
+jsi::Object V8Runtime::getPromise(const jsi::Object &resolver) {
+  _ISOLATE_CONTEXT_ENTER
+  return make<jsi::Object>(
+      makePointerValue(AsPromiseResolver(objectRef(resolver))->GetPromise()));
+}
+
+void V8Runtime::settlePromise(
+    const jsi::Object &resolver,
+    const jsi::Value &result,
+    bool reject) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Promise::Resolver> promiseResolver =
+      AsPromiseResolver(objectRef(resolver));
+  v8::TryCatch trycatch(isolate);
+
+  v8::Maybe<bool> settled = reject
+      ? promiseResolver->Reject(context, valueRef(result))
+      : promiseResolver->Resolve(context, valueRef(result));
+  if (settled.IsNothing()) {
+    if (trycatch.HasCaught()) {
+      ReportException(&trycatch);
+    }
+    throw jsi::JSError(*this, "V8Runtime::settlePromise failed.");
+  }
+}
+
+jsi::Function V8Runtime::createFunctionFromHostFunction(
+    const jsi::PropNameID &name,
+    unsigned int paramCount,
+    jsi::HostFunctionType func,
+    const v8::CFunction *fastFunction) {
+  _ISOLATE_CONTEXT_ENTER
+
+  HostFunctionProxy *hostFunctionProxy = new HostFunctionProxy(*this, func);
+  v8::Local<v8::External> data = v8::External::New(isolate, hostFunctionProxy);
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  // v8::Function::New has no fast path, only templates do. The slow callback
+  // is the regular host function one. The context caches what it instantiates
+  // from a template for good, so only take that route for a fast function.
+  v8::MaybeLocal<v8::Function> maybeFunction;
+  if (fastFunction) {
+    maybeFunction = v8::FunctionTemplate::New(
+                        isolate,
+                        HostFunctionProxy::HostFunctionCallback,
+                        data,
+                        v8::Local<v8::Signature>(),
+                        static_cast<int>(paramCount),
+                        v8::ConstructorBehavior::kThrow,
+                        v8::SideEffectType::kHasSideEffect,
+                        fastFunction)
+                        ->GetFunction(context);
+  } else {
+    maybeFunction = v8::Function::New(
+        context,
+        HostFunctionProxy::HostFunctionCallback,
+        data,
+        static_cast<int>(paramCount),
+        v8::ConstructorBehavior::kThrow);
+  }
+
+  v8::Local<v8::Function> newFunction;
+  if (!maybeFunction.ToLocal(&newFunction)) {
+    delete hostFunctionProxy;
+    throw jsi::JSError(*this, "Creation of HostFunction failed.");
+  }
+
+  newFunction->SetName(v8::Local<v8::String>::Cast(valueRef(name)));
+
+  AddHostObjectLifetimeTracker(std::make_shared<HostObjectLifetimeTracker>(
+      *this, newFunction, hostFunctionProxy));
+
+  return make<jsi::Object>(makePointerValue(newFunction)).getFunction(*this);
 }
 
 bool V8Runtime::isHostFunction(const jsi::Function &obj) const {
@@ -1315,10 +2543,7 @@ jsi::Value V8Runtime::call(
   _ISOLATE_CONTEXT_ENTER
   v8::Local<v8::Function> func =
       v8::Local<v8::Function>::Cast(objectRef(jsiFunc));
-  std::vector<v8::Local<v8::Value>> argv;
-  for (size_t i = 0; i < count; i++) {
-    argv.push_back(valueRef(args[i]));
-  }
+  CallArguments argv(*this, args, count);
 
   v8::TryCatch trycatch(isolate_);
   v8::MaybeLocal<v8::Value> result = func->Call(
@@ -1339,6 +2564,41 @@ jsi::Value V8Runtime::call(
   }
 }
 
+void V8Runtime::callBatch(
+    const jsi::Function &jsiFunc,
+    const jsi::Value &jsThis,
+    const jsi::Value *args,
+    size_t argsPerCall,
+    size_t callCount,
+    jsi::Value *results) {
+  _ISOLATE_CONTEXT_ENTER
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Function> func =
+      v8::Local<v8::Function>::Cast(objectRef(jsiFunc));
+  v8::Local<v8::Value> thisRef = valueRef(jsThis);
+
+  // The results are created in the per call HandleScopes below.
+  ScopeSuspension suspension(*this);
+  v8::TryCatch trycatch(isolate_);
+  for (size_t call = 0; call < callCount; call++) {
+    // Keeps the arguments and the result of one call from piling up.
+    v8::HandleScope call_scope(isolate);
+    CallArguments argv(*this, args + call * argsPerCall, argsPerCall);
+
+    v8::MaybeLocal<v8::Value> result = func->Call(
+        context, thisRef, static_cast<int>(argsPerCall), argv.data());
+
+    if (trycatch.HasCaught()) {
+      ReportException(&trycatch);
+    }
+
+    if (results != nullptr) {
+      results[call] = result.IsEmpty() ? jsi::Value()
+                                       : createValue(result.ToLocalChecked());
+    }
+  }
+}
+
 jsi::Value V8Runtime::callAsConstructor(
     const jsi::Function &jsiFunc,
     const jsi::Value *args,
@@ -1346,10 +2606,7 @@ jsi::Value V8Runtime::callAsConstructor(
   _ISOLATE_CONTEXT_ENTER
   v8::Local<v8::Function> func =
       v8::Local<v8::Function>::Cast(objectRef(jsiFunc));
-  std::vector<v8::Local<v8::Value>> argv;
-  for (size_t i = 0; i < count; i++) {
-    argv.push_back(valueRef(args[i]));
-  }
+  CallArguments argv(*this, args, count);
 
   v8::TryCatch trycatch(isolate_);
   v8::Local<v8::Object> newObject;
@@ -1358,11 +2615,10 @@ jsi::Value V8Runtime::callAsConstructor(
                static_cast<int>(count),
                argv.data())
            .ToLocal(&newObject)) {
-    new jsi::JSError(*this, "Object construction failed!!");
-  }
-
-  if (trycatch.HasCaught()) {
-    ReportException(&trycatch);
+    if (trycatch.HasCaught()) {
+      ReportException(&trycatch);
+    }
+    throw jsi::JSError(*this, "Object construction failed!!");
   }
 
   return createValue(newObject);
@@ -1390,28 +2646,30 @@ bool V8Runtime::instanceOf(const jsi::Object &o, const jsi::Function &f) {
       .ToChecked();
 }
 
-jsi::Value V8Runtime::createValue(v8::Local<v8::Value> value) const {
-  _ISOLATE_CONTEXT_ENTER
-  if (value->IsInt32()) {
-    return jsi::Value(
-        value->Int32Value(GetIsolate()->GetCurrentContext()).ToChecked());
-  }
-  if (value->IsNumber()) {
-    return jsi::Value(
-        value->NumberValue(GetIsolate()->GetCurrentContext()).ToChecked());
+// Being handed a Local, the caller already has a HandleScope; the primitive
+// conversions below don't need a context either.
+jsi::Value V8Runtime::createValue(
+    v8::Local<v8::Value> value,
+    bool isLocal) const {
+  if (value.IsEmpty()) {
+    return jsi::Value(nullptr);
+  } else if (value->IsInt32()) {
+    return jsi::Value(value.As<v8::Int32>()->Value());
+  } else if (value->IsNumber()) {
+    return jsi::Value(value.As<v8::Number>()->Value());
   } else if (value->IsBoolean()) {
-    return jsi::Value(value->BooleanValue(GetIsolate()));
+    return jsi::Value(value.As<v8::Boolean>()->Value());
   } else if (value->IsUndefined()) {
     return jsi::Value();
-  } else if (value.IsEmpty() || value->IsNull()) {
+  } else if (value->IsNull()) {
     return jsi::Value(nullptr);
   } else if (value->IsString()) {
     // Note :: Non copy create
-    return make<jsi::String>(V8StringValue::make(v8::Local<v8::String>::Cast(value)));
+    return make<jsi::String>(makePointerValue(value, isLocal));
   } else if (value->IsObject()) {
-    return make<jsi::Object>(V8ObjectValue::make(v8::Local<v8::Object>::Cast(value)));
+    return make<jsi::Object>(makePointerValue(value, isLocal));
   } else if (value->IsSymbol()) {
-    return make<jsi::Symbol>(V8PointerValue<v8::Symbol>::make(v8::Local<v8::Symbol>::Cast(value)));
+    return make<jsi::Symbol>(makePointerValue(value, isLocal));
   } else {
     // What are you?
     std::abort();
@@ -1419,23 +2677,16 @@ jsi::Value V8Runtime::createValue(v8::Local<v8::Value> value) const {
 }
 
 v8::Local<v8::Value> V8Runtime::valueRef(const jsi::Value &value) {
-  v8::EscapableHandleScope handle_scope(v8::Isolate::GetCurrent());
-
   if (value.isUndefined()) {
-    return handle_scope.Escape(v8::Undefined(GetIsolate()));
+    return v8::Undefined(GetIsolate());
   } else if (value.isNull()) {
-    return handle_scope.Escape(v8::Null(GetIsolate()));
+    return v8::Null(GetIsolate());
   } else if (value.isBool()) {
-    return handle_scope.Escape(v8::Boolean::New(GetIsolate(), value.getBool()));
+    return v8::Boolean::New(GetIsolate(), value.getBool());
   } else if (value.isNumber()) {
-    return handle_scope.Escape(
-        v8::Number::New(GetIsolate(), value.getNumber()));
-  } else if (value.isString()) {
-    return handle_scope.Escape(stringRef(value.asString(*this)));
-  } else if (value.isObject()) {
-    return handle_scope.Escape(objectRef(value.getObject(*this)));
-  } else if (value.isSymbol()) {
-    return handle_scope.Escape(symbolRef(value.getSymbol(*this)));
+    return v8::Number::New(GetIsolate(), value.getNumber());
+  } else if (value.isString() || value.isObject() || value.isSymbol()) {
+    return pvRef<v8::Value>(getPointerValue(value));
   } else {
     // What are you?
     std::abort();
@@ -1450,4 +2701,228 @@ std::unique_ptr<jsi::Runtime> makeV8Runtime() {
   return std::make_unique<V8Runtime>(V8RuntimeArgs());
 }
 
+void enterScope(jsi::Runtime &runtime) {
+  static_cast<V8Runtime &>(runtime).enterScope();
+}
+
+void exitScope(jsi::Runtime &runtime) {
+  static_cast<V8Runtime &>(runtime).exitScope();
+}
+
+V8RuntimeStats getRuntimeStats(jsi::Runtime &runtime) {
+  return static_cast<V8Runtime &>(runtime).getStats();
+}
+
+bool drainMicrotasks(jsi::Runtime &runtime, int maxMicrotasksHint) {
+  return static_cast<V8Runtime &>(runtime).drainMicrotasks(maxMicrotasksHint);
+}
+
+bool stringifyJsonUtf8(
+    jsi::Runtime &runtime,
+    const jsi::Value &value,
+    std::string &json) {
+  return static_cast<V8Runtime &>(runtime).stringifyJsonUtf8(value, json);
+}
+
+jsi::String createStringFromUtf16(
+    jsi::Runtime &runtime,
+    const char16_t *utf16,
+    size_t length) {
+  return static_cast<V8Runtime &>(runtime).createStringFromUtf16(
+      utf16, length);
+}
+
+void appendUtf16(
+    jsi::Runtime &runtime,
+    const jsi::String &str,
+    std::u16string &out) {
+  static_cast<V8Runtime &>(runtime).appendUtf16(str, out);
+}
+
+std::u16string utf16(jsi::Runtime &runtime, const jsi::String &str) {
+  std::u16string result;
+  static_cast<V8Runtime &>(runtime).appendUtf16(str, result);
+  return result;
+}
+
+void appendUtf8(
+    jsi::Runtime &runtime,
+    const jsi::String &str,
+    std::string &out) {
+  static_cast<V8Runtime &>(runtime).appendUtf8(str, out);
+}
+
+void appendUtf8(
+    jsi::Runtime &runtime,
+    const jsi::PropNameID &name,
+    std::string &out) {
+  static_cast<V8Runtime &>(runtime).appendUtf8(name, out);
+}
+
+jsi::Array createArrayFromValues(
+    jsi::Runtime &runtime,
+    const jsi::Value *values,
+    size_t count) {
+  return static_cast<V8Runtime &>(runtime).createArrayFromValues(values, count);
+}
+
+void getArrayValues(
+    jsi::Runtime &runtime,
+    const jsi::Array &array,
+    std::vector<jsi::Value> &values,
+    size_t start,
+    size_t count) {
+  static_cast<V8Runtime &>(runtime).getArrayValues(
+      array, values, start, count);
+}
+
+jsi::Object createTypedArray(
+    jsi::Runtime &runtime,
+    TypedArrayKind kind,
+    const jsi::ArrayBuffer &buffer,
+    size_t byteOffset,
+    size_t length) {
+  return static_cast<V8Runtime &>(runtime).createTypedArray(
+      kind, buffer, byteOffset, length);
+}
+
+jsi::Object createTypedArray(
+    jsi::Runtime &runtime,
+    TypedArrayKind kind,
+    const void *data,
+    size_t length) {
+  return static_cast<V8Runtime &>(runtime).createTypedArray(
+      kind, data, length);
+}
+
+bool getTypedArrayData(
+    jsi::Runtime &runtime,
+    const jsi::Object &object,
+    TypedArrayData &out) {
+  return static_cast<V8Runtime &>(runtime).getTypedArrayData(object, out);
+}
+
+jsi::Object createPromiseResolver(jsi::Runtime &runtime) {
+  return static_cast<V8Runtime &>(runtime).createPromiseResolver();
+}
+
+jsi::Object getPromise(jsi::Runtime &runtime, const jsi::Object &resolver) {
+  return static_cast<V8Runtime &>(runtime).getPromise(resolver);
+}
+
+void resolvePromise(
+    jsi::Runtime &runtime,
+    const jsi::Object &resolver,
+    const jsi::Value &value) {
+  static_cast<V8Runtime &>(runtime).settlePromise(
+      resolver, value, false /*reject*/);
+}
+
+void rejectPromise(
+    jsi::Runtime &runtime,
+    const jsi::Object &resolver,
+    const jsi::Value &reason) {
+  static_cast<V8Runtime &>(runtime).settlePromise(
+      resolver, reason, true /*reject*/);
+}
+
+jsi::Function createFunctionFromHostFunction(
+    jsi::Runtime &runtime,
+    const jsi::PropNameID &name,
+    unsigned int paramCount,
+    jsi::HostFunctionType func,
+    const v8::CFunction *fastFunction) {
+  return static_cast<V8Runtime &>(runtime).createFunctionFromHostFunction(
+      name, paramCount, std::move(func), fastFunction);
+}
+
+HostObjectClass *createHostObjectClass(
+    jsi::Runtime &runtime,
+    HostObjectClassDescription description) {
+  return static_cast<V8Runtime &>(runtime).createHostObjectClass(
+      std::move(description));
+}
+
+jsi::Object createHostObject(
+    jsi::Runtime &runtime,
+    HostObjectClass *hostObjectClass,
+    std::shared_ptr<jsi::HostObject> hostObject) {
+  return static_cast<V8Runtime &>(runtime).createHostObject(
+      hostObjectClass, std::move(hostObject));
+}
+
+void getProperties(
+    jsi::Runtime &runtime,
+    const jsi::Object &object,
+    const jsi::PropNameID *names,
+    size_t count,
+    jsi::Value *values) {
+  static_cast<V8Runtime &>(runtime).getProperties(object, names, count, values);
+}
+
+void setProperties(
+    jsi::Runtime &runtime,
+    jsi::Object &object,
+    const jsi::PropNameID *names,
+    const jsi::Value *values,
+    size_t count) {
+  static_cast<V8Runtime &>(runtime).setProperties(object, names, values, count);
+}
+
+void getOwnProperties(
+    jsi::Runtime &runtime,
+    const jsi::Object &object,
+    std::vector<jsi::PropNameID> &names,
+    std::vector<jsi::Value> &values) {
+  static_cast<V8Runtime &>(runtime).getOwnProperties(object, names, values);
+}
+
+void visitValueTree(
+    jsi::Runtime &runtime,
+    const jsi::Value &value,
+    ValueTreeVisitor &visitor) {
+  static_cast<V8Runtime &>(runtime).visitValueTree(value, visitor);
+}
+
+jsi::Value buildValueTree(
+    jsi::Runtime &runtime,
+    const std::function<void(ValueTreeVisitor &)> &produce) {
+  return static_cast<V8Runtime &>(runtime).buildValueTree(produce);
+}
+
+void callBatch(
+    jsi::Runtime &runtime,
+    const jsi::Function &func,
+    const jsi::Value &jsThis,
+    const jsi::Value *args,
+    size_t argsPerCall,
+    size_t callCount,
+    jsi::Value *results) {
+  static_cast<V8Runtime &>(runtime).callBatch(
+      func, jsThis, args, argsPerCall, callCount, results);
+}
+
+jsi::ArrayBuffer createExternalArrayBuffer(
+    jsi::Runtime &runtime,
+    uint8_t *data,
+    size_t size,
+    std::function<void(uint8_t *)> deleter) {
+  return static_cast<V8Runtime &>(runtime).createExternalArrayBuffer(
+      data, size, std::move(deleter));
+}
+
+jsi::ArrayBuffer createArrayBuffer(
+    jsi::Runtime &runtime,
+    std::shared_ptr<const jsi::Buffer> buffer) {
+  return static_cast<V8Runtime &>(runtime).createArrayBuffer(
+      buffer->data(), buffer->size());
+}
+
+jsi::Object createIndexedHostObject(
+    jsi::Runtime &runtime,
+    std::shared_ptr<IndexedHostObject> hostObject) {
+  return static_cast<V8Runtime &>(runtime).createIndexedHostObject(
+      std::move(hostObject));
+}
+
 } // namespace v8runtime
@@ -17,8 +17,11 @@
 #include <iostream>
 #include <list>
 #include <mutex>
+#include <new>
 #include <sstream>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include <cstdlib>
 
@@ -135,6 +138,17 @@ class V8PlatformHolder {
 
 }; // namespace v8runtime
 
+class HostObjectClass {
+ public:
+  explicit HostObjectClass(HostObjectClassDescription &&description)
+      : description(std::move(description)) {}
+
+  // The accessors and methods point into the description, so it must not be
+  // modified once the class is created.
+  const HostObjectClassDescription description;
+  v8::Global<v8::Function> constructor;
+};
+
 class V8Runtime : public facebook::jsi::Runtime {
  public:
   V8Runtime(V8RuntimeArgs &&args);
@@ -158,11 +172,308 @@ class V8Runtime : public facebook::jsi::Runtime {
 
   bool isInspectable() override;
 
+  // A jsi::Scope opens a HandleScope. While it is the innermost scope, values
+  // created by JSI calls are backed by locals of that HandleScope instead of
+  // global handles; the ones still alive when it is popped are promoted.
+  ScopeState *pushScope() override;
+  void popScope(ScopeState *) override;
+
+  // Backing for v8runtime::EnterScope. While at least one session is open the
+  // isolate and the runtime context stay entered, so individual JSI calls
+  // don't have to set them up again.
+  void enterScope();
+  void exitScope();
+
+  V8RuntimeStats getStats() const;
+
+  // Backing for v8runtime::drainMicrotasks.
+  bool drainMicrotasks(int maxMicrotasksHint);
+
+  facebook::jsi::Object createIndexedHostObject(
+      std::shared_ptr<IndexedHostObject> hostObject);
+
+  // Backing for the v8runtime promise resolver functions.
+  facebook::jsi::Object createPromiseResolver();
+  facebook::jsi::Object getPromise(const facebook::jsi::Object &resolver);
+  void settlePromise(
+      const facebook::jsi::Object &resolver,
+      const facebook::jsi::Value &result,
+      bool reject);
+
+  // Backing for v8runtime::createFunctionFromHostFunction.
+  facebook::jsi::Function createFunctionFromHostFunction(
+      const facebook::jsi::PropNameID &name,
+      unsigned int paramCount,
+      facebook::jsi::HostFunctionType func,
+      const v8::CFunction *fastFunction);
+
+  // Backing for v8runtime::createHostObjectClass and the matching
+  // v8runtime::createHostObject.
+  HostObjectClass *createHostObjectClass(
+      HostObjectClassDescription &&description);
+  facebook::jsi::Object createHostObject(
+      HostObjectClass *hostObjectClass,
+      std::shared_ptr<facebook::jsi::HostObject> hostObject);
+
+  // Backing for v8runtime::createExternalArrayBuffer.
+  facebook::jsi::ArrayBuffer createExternalArrayBuffer(
+      uint8_t *data,
+      size_t size,
+      std::function<void(uint8_t *)> deleter);
+
+  // Backing for v8runtime::createArrayBuffer.
+  facebook::jsi::ArrayBuffer createArrayBuffer(
+      const uint8_t *data,
+      size_t size);
+
+  // Backing for v8runtime::createTypedArray and v8runtime::getTypedArrayData.
+  facebook::jsi::Object createTypedArray(
+      TypedArrayKind kind,
+      const facebook::jsi::ArrayBuffer &buffer,
+      size_t byteOffset,
+      size_t length);
+  facebook::jsi::Object
+  createTypedArray(TypedArrayKind kind, const void *data, size_t length);
+  bool getTypedArrayData(
+      const facebook::jsi::Object &object,
+      TypedArrayData &out);
+
+  // Backing for the v8runtime UTF-16 string functions.
+  facebook::jsi::String createStringFromUtf16(
+      const char16_t *utf16,
+      size_t length);
+  void appendUtf16(const facebook::jsi::String &str, std::u16string &out);
+
+  // Backing for v8runtime::appendUtf8.
+  void appendUtf8(const facebook::jsi::String &str, std::string &out);
+  void appendUtf8(const facebook::jsi::PropNameID &name, std::string &out);
+
+  // Backing for v8runtime::stringifyJsonUtf8.
+  bool stringifyJsonUtf8(const facebook::jsi::Value &value, std::string &json);
+
+  // Backing for v8runtime::createArrayFromValues and v8runtime::getArrayValues.
+  facebook::jsi::Array createArrayFromValues(
+      const facebook::jsi::Value *values,
+      size_t count);
+  void getArrayValues(
+      const facebook::jsi::Array &array,
+      std::vector<facebook::jsi::Value> &values,
+      size_t start,
+      size_t count);
+
+  // Backing for v8runtime::getProperties and v8runtime::setProperties.
+  void getProperties(
+      const facebook::jsi::Object &object,
+      const facebook::jsi::PropNameID *names,
+      size_t count,
+      facebook::jsi::Value *values);
+  void setProperties(
+      facebook::jsi::Object &object,
+      const facebook::jsi::PropNameID *names,
+      const facebook::jsi::Value *values,
+      size_t count);
+
+  // Backing for v8runtime::getOwnProperties.
+  void getOwnProperties(
+      const facebook::jsi::Object &object,
+      std::vector<facebook::jsi::PropNameID> &names,
+      std::vector<facebook::jsi::Value> &values);
+
+  // Backing for v8runtime::visitValueTree and v8runtime::buildValueTree.
+  void visitValueTree(
+      const facebook::jsi::Value &value,
+      ValueTreeVisitor &visitor);
+  facebook::jsi::Value buildValueTree(
+      const std::function<void(ValueTreeVisitor &)> &produce);
+
+  // Backing for v8runtime::callBatch.
+  void callBatch(
+      const facebook::jsi::Function &func,
+      const facebook::jsi::Value &jsThis,
+      const facebook::jsi::Value *args,
+      size_t argsPerCall,
+      size_t callCount,
+      facebook::jsi::Value *results);
+
  private:
+  class ValueTreeReader;
+  class ValueTreeBuilder;
+
+  // Converts the arguments of a call from JSI to V8 without a heap allocation
+  // for up to kMaxStackArgs arguments. The locals live in the caller's
+  // HandleScope.
+  class CallArguments {
+   public:
+    CallArguments(
+        V8Runtime &runtime,
+        const facebook::jsi::Value *args,
+        size_t count)
+        : argv_(stackArgs_) {
+      if (count > kMaxStackArgs) {
+        heapArgs_.resize(count);
+        argv_ = heapArgs_.data();
+      }
+      for (size_t i = 0; i < count; i++) {
+        argv_[i] = runtime.valueRef(args[i]);
+      }
+    }
+
+    v8::Local<v8::Value> *data() {
+      return argv_;
+    }
+
+   private:
+    CallArguments(const CallArguments &) = delete;
+    CallArguments &operator=(const CallArguments &) = delete;
+
+    static constexpr size_t kMaxStackArgs = 8;
+
+    v8::Local<v8::Value> stackArgs_[kMaxStackArgs];
+    std::vector<v8::Local<v8::Value>> heapArgs_;
+    v8::Local<v8::Value> *argv_;
+  };
+
+  // v8::HandleScope can't be allocated with new; this holds one in place so
+  // that it can be opened conditionally, or as part of a jsi::Scope's state.
+  class HandleScopeHolder {
+   public:
+    HandleScopeHolder() = default;
+
+    ~HandleScopeHolder() {
+      close();
+    }
+
+    void open(v8::Isolate *isolate) {
+      assert(!open_);
+      ::new (&storage_) v8::HandleScope(isolate);
+      open_ = true;
+    }
+
+    void close() {
+      if (open_) {
+        reinterpret_cast<v8::HandleScope *>(&storage_)->~HandleScope();
+        open_ = false;
+      }
+    }
+
+   private:
+    HandleScopeHolder(const HandleScopeHolder &) = delete;
+    HandleScopeHolder &operator=(const HandleScopeHolder &) = delete;
+
+    typename std::aligned_storage<
+        sizeof(v8::HandleScope),
+        alignof(v8::HandleScope)>::type storage_;
+    bool open_{false};
+  };
+
+  class V8PointerValue;
+
+  // State behind a jsi::Scope, see pushScope.
+  struct HandleScopeState {
+    HandleScopeHolder handleScope;
+    HandleScopeState *previous{nullptr};
+
+    // Values allocated as locals of handleScope. Entries may have been
+    // released (and reused) since; popScope only promotes the ones that are
+    // still local.
+    std::vector<V8PointerValue *> locals;
+  };
+
+  // Locals created by code running inside a V8 callback or a nested
+  // HandleScope don't live as long as the jsi::Scope. Such code suspends
+  // scope backed values until it returns.
+  class ScopeSuspension {
+   public:
+    explicit ScopeSuspension(const V8Runtime &runtime)
+        : runtime_(runtime), scope_(runtime.current_scope_) {
+      runtime_.current_scope_ = nullptr;
+    }
+
+    ~ScopeSuspension() {
+      runtime_.current_scope_ = scope_;
+    }
+
+   private:
+    ScopeSuspension(const ScopeSuspension &) = delete;
+    ScopeSuspension &operator=(const ScopeSuspension &) = delete;
+
+    const V8Runtime &runtime_;
+    HandleScopeState *scope_;
+  };
+
+  // Enters the isolate and the runtime context for the duration of a JSI
+  // call, unless an enclosing JSI call or an EnterScope session already did.
+  // The context is checked rather than the depth: runtimes on one thread
+  // share the isolate, and another runtime's callback may call back into
+  // this one while its own context is current.
+  // A HandleScope is opened so that locals created by the call don't
+  // accumulate in a long-lived session, except directly inside a jsi::Scope:
+  // its HandleScope then holds the locals backing the values the call
+  // returns.
+  class IsolateContextScope {
+   public:
+    IsolateContextScope(v8::Isolate *isolate, const V8Runtime &runtime)
+        : entry_(isolate, runtime) {
+      if (runtime.current_scope_ == nullptr) {
+        handle_scope_.open(isolate);
+      }
+
+      if (runtime.context_ != isolate->GetCurrentContext()) {
+        context_ = runtime.context_.Get(isolate);
+        context_->Enter();
+      }
+    }
+
+    ~IsolateContextScope() {
+      if (!context_.IsEmpty()) {
+        context_->Exit();
+      }
+    }
+
+   private:
+    IsolateContextScope(const IsolateContextScope &) = delete;
+    IsolateContextScope &operator=(const IsolateContextScope &) = delete;
+
+    // Separate member so that the isolate is entered before and exited after
+    // the HandleScope.
+    class Entry {
+     public:
+      Entry(v8::Isolate *isolate, const V8Runtime &runtime)
+          : isolate_(isolate),
+            runtime_(runtime),
+            outermost_(runtime.entered_depth_++ == 0) {
+        if (outermost_) {
+          isolate_->Enter();
+        }
+      }
+
+      ~Entry() {
+        if (outermost_) {
+          isolate_->Exit();
+        }
+        --runtime_.entered_depth_;
+      }
+
+     private:
+      v8::Isolate *isolate_;
+      const V8Runtime &runtime_;
+      bool outermost_;
+    };
+
+    Entry entry_;
+    HandleScopeHolder handle_scope_;
+    v8::Local<v8::Context> context_;
+  };
+
   struct IHostProxy {
+    virtual ~IHostProxy() = default;
     virtual void destroy() = 0;
   };
 
+  class HostObjectLifetimeTracker;
+  using HostObjectLifetimeTrackerList =
+      std::list<std::shared_ptr<HostObjectLifetimeTracker>>;
+
   class HostObjectLifetimeTracker {
    public:
     void ResetHostObject(bool isGC /*whether the call is coming from GC*/) {
@@ -174,11 +485,12 @@ class V8Runtime : public facebook::jsi::Runtime {
       }
     }
 
+    // Takes ownership of hostProxy.
     HostObjectLifetimeTracker(
         V8Runtime &runtime,
         v8::Local<v8::Object> obj,
         IHostProxy *hostProxy)
-        : hostProxy_(hostProxy) {
+        : runtime_(runtime), hostProxy_(hostProxy) {
       objectTracker_.Reset(runtime.GetIsolate(), obj);
       objectTracker_.SetWeak(
           this,
@@ -191,71 +503,84 @@ class V8Runtime : public facebook::jsi::Runtime {
       assert(isReset_);
     }
 
-    bool IsEqual(IHostProxy *hostProxy) const noexcept {
-      return hostProxy_ == hostProxy;
-    }
-
    private:
+    friend class V8Runtime;
+
+    V8Runtime &runtime_;
     v8::Global<v8::Object> objectTracker_;
     std::atomic<bool> isReset_{false};
-    IHostProxy *hostProxy_;
+    std::unique_ptr<IHostProxy> hostProxy_;
+
+    // Position in the runtime's tracker list, for O(1) removal.
+    HostObjectLifetimeTrackerList::iterator position_;
 
     static void Destroyed(
         const v8::WeakCallbackInfo<HostObjectLifetimeTracker> &data) {
       v8::HandleScope handle_scope(v8::Isolate::GetCurrent());
-      data.GetParameter()->ResetHostObject(true /*isGC*/);
+      HostObjectLifetimeTracker *tracker = data.GetParameter();
+      tracker->ResetHostObject(true /*isGC*/);
+
+      // Drops the last reference to the tracker, and with it the proxy.
+      tracker->runtime_.RemoveHostObjectLifetimeTracker(tracker);
     }
   };
 
   class HostObjectProxy : public IHostProxy {
    private:
-    static void GetInternal(
-        std::string propName,
-        const v8::PropertyCallbackInfo<v8::Value> &info) {
+    template <typename T>
+    static HostObjectProxy *FromInfo(const v8::PropertyCallbackInfo<T> &info) {
       v8::Local<v8::External> data =
           v8::Local<v8::External>::Cast(info.This()->GetInternalField(0));
-      HostObjectProxy *hostObjectProxy =
-          reinterpret_cast<HostObjectProxy *>(data->Value());
-
-      if (hostObjectProxy == nullptr)
-        std::abort();
-
-      V8Runtime &runtime = hostObjectProxy->runtime_;
-      std::shared_ptr<facebook::jsi::HostObject> hostObject =
-          hostObjectProxy->hostObject_;
+      return reinterpret_cast<HostObjectProxy *>(data->Value());
+    }
 
-      facebook::jsi::Value result;
+    // Schedules the C++ exception currently being handled to be thrown back
+    // to JS. Must be called from within a catch block.
+    static void RethrowToJS(V8Runtime &runtime, v8::Isolate *isolate) {
       try {
-        result = hostObject->get(runtime, runtime.createPropNameIDFromUtf8(
-                reinterpret_cast<uint8_t *>(&propName[0]), propName.length()));
+        throw;
       } catch (const facebook::jsi::JSError& error) {
-        info.GetReturnValue().Set(v8::Undefined(info.GetIsolate()));
-
-        // Schedule to throw the exception back to JS.
-        info.GetIsolate()->ThrowException(runtime.valueRef(error.value()));
-        return;
+        isolate->ThrowException(runtime.valueRef(error.value()));
       } catch (const std::exception& ex) {
-        info.GetReturnValue().Set(v8::Undefined(info.GetIsolate()));
-
-        // Schedule to throw the exception back to JS.
         v8::Local<v8::String> message =
-            v8::String::NewFromUtf8(info.GetIsolate(), ex.what(),
+            v8::String::NewFromUtf8(isolate, ex.what(),
                                     v8::NewStringType::kNormal)
                 .ToLocalChecked();
-        info.GetIsolate()->ThrowException(v8::Exception::Error(message));
-        return;
+        isolate->ThrowException(v8::Exception::Error(message));
       } catch (...) {
-        info.GetReturnValue().Set(v8::Undefined(info.GetIsolate()));
-
-        // Schedule to throw the exception back to JS.
         v8::Local<v8::String> message =
             v8::String::NewFromOneByte(
-                info.GetIsolate(),
+                isolate,
                 reinterpret_cast<const uint8_t*>(
                     "<Unknown exception in host function callback>"),
                 v8::NewStringType::kNormal)
                 .ToLocalChecked();
-        info.GetIsolate()->ThrowException(v8::Exception::Error(message));
+        isolate->ThrowException(v8::Exception::Error(message));
+      }
+    }
+
+    static void GetInternal(
+        v8::Local<v8::String> propName,
+        const v8::PropertyCallbackInfo<v8::Value> &info) {
+      HostObjectProxy *hostObjectProxy = FromInfo(info);
+
+      if (hostObjectProxy == nullptr)
+        std::abort();
+
+      V8Runtime &runtime = hostObjectProxy->runtime_;
+      ScopeSuspension suspension(runtime);
+      std::shared_ptr<facebook::jsi::HostObject> hostObject =
+          hostObjectProxy->hostObject_;
+
+      facebook::jsi::Value result;
+      try {
+        result = hostObject->get(
+            runtime,
+            make<facebook::jsi::PropNameID>(
+                runtime.makePointerValue(propName, true /*isLocal*/)));
+      } catch (...) {
+        info.GetReturnValue().Set(v8::Undefined(info.GetIsolate()));
+        RethrowToJS(runtime, info.GetIsolate());
         return;
       }
 
@@ -263,96 +588,211 @@ class V8Runtime : public facebook::jsi::Runtime {
     }
 
     static void SetInternal(
-        std::string propName,
+        v8::Local<v8::String> propName,
         v8::Local<v8::Value> value,
         const v8::PropertyCallbackInfo<v8::Value> &info) {
-      v8::Local<v8::External> data =
-          v8::Local<v8::External>::Cast(info.This()->GetInternalField(0));
-      HostObjectProxy *hostObjectProxy =
-          reinterpret_cast<HostObjectProxy *>(data->Value());
+      HostObjectProxy *hostObjectProxy = FromInfo(info);
 
       if (hostObjectProxy == nullptr)
         std::abort();
 
       V8Runtime &runtime = hostObjectProxy->runtime_;
+      ScopeSuspension suspension(runtime);
       std::shared_ptr<facebook::jsi::HostObject> hostObject =
           hostObjectProxy->hostObject_;
 
       try {
         hostObject->set(
             runtime,
-            runtime.createPropNameIDFromUtf8(
-                reinterpret_cast<uint8_t *>(&propName[0]), propName.length()),
-            runtime.createValue(value));
-      } catch (const facebook::jsi::JSError& error) {
-        // Schedule to throw the exception back to JS.
-        info.GetIsolate()->ThrowException(runtime.valueRef(error.value()));
-      } catch (const std::exception& ex) {
-        // Schedule to throw the exception back to JS.
-        v8::Local<v8::String> message =
-            v8::String::NewFromUtf8(info.GetIsolate(), ex.what(),
-                                    v8::NewStringType::kNormal)
-                .ToLocalChecked();
-        info.GetIsolate()->ThrowException(v8::Exception::Error(message));
+            make<facebook::jsi::PropNameID>(
+                runtime.makePointerValue(propName, true /*isLocal*/)),
+            runtime.createValue(value, true /*isLocal*/));
       } catch (...) {
-        // Schedule to throw the exception back to JS.
-        v8::Local<v8::String> message =
-            v8::String::NewFromOneByte(
-                info.GetIsolate(),
-                reinterpret_cast<const uint8_t*>(
-                    "<Unknown exception in host function callback>"),
-                v8::NewStringType::kNormal)
-                .ToLocalChecked();
-        info.GetIsolate()->ThrowException(v8::Exception::Error(message));
+        RethrowToJS(runtime, info.GetIsolate());
       }
     }
 
    public:
+    // The incoming name is handed to the HostObject as is. JSI property
+    // names can't be symbols, so symbol keyed accesses aren't intercepted and
+    // fall through to the ordinary lookup on the object.
     static void Get(
         v8::Local<v8::Name> v8PropName,
         const v8::PropertyCallbackInfo<v8::Value> &info) {
-      v8::Local<v8::String> propNameStr = v8::Local<v8::String>::Cast(v8PropName);
+      if (v8PropName->IsSymbol())
+        return;
 
-      std::string propName;
-      propName.resize(propNameStr->Utf8Length(info.GetIsolate()));
-      propNameStr->WriteUtf8(info.GetIsolate(), &propName[0]);
-      GetInternal(propName, info);
+      GetInternal(v8::Local<v8::String>::Cast(v8PropName), info);
     }
 
+    // IndexedHostObjects get the index as is, plain HostObjects see it as a
+    // property name.
     static void GetIndexed(
         uint32_t index,
         const v8::PropertyCallbackInfo<v8::Value> &info) {
-      std::string propName = std::to_string(index);
-      GetInternal(propName, info);
+      HostObjectProxy *hostObjectProxy = FromInfo(info);
+
+      if (hostObjectProxy == nullptr)
+        std::abort();
+
+      if (!hostObjectProxy->indexedHostObject_) {
+        GetInternal(IndexToString(info.GetIsolate(), index), info);
+        return;
+      }
+
+      V8Runtime &runtime = hostObjectProxy->runtime_;
+      ScopeSuspension suspension(runtime);
+      std::shared_ptr<facebook::jsi::HostObject> hostObject =
+          hostObjectProxy->hostObject_;
+      IndexedHostObject *indexedHostObject =
+          hostObjectProxy->indexedHostObject_;
+
+      facebook::jsi::Value result;
+      try {
+        if (index < indexedHostObject->length(runtime)) {
+          result = indexedHostObject->getIndex(runtime, index);
+        }
+      } catch (...) {
+        info.GetReturnValue().Set(v8::Undefined(info.GetIsolate()));
+        RethrowToJS(runtime, info.GetIsolate());
+        return;
+      }
+
+      info.GetReturnValue().Set(runtime.valueRef(result));
     }
 
     static void Set(
         v8::Local<v8::Name> v8PropName,
         v8::Local<v8::Value> value,
         const v8::PropertyCallbackInfo<v8::Value> &info) {
-      v8::Local<v8::String> propNameStr = v8::Local<v8::String>::Cast(v8PropName);
+      if (v8PropName->IsSymbol())
+        return;
 
-      std::string propName;
-      propName.resize(propNameStr->Utf8Length(info.GetIsolate()));
-      propNameStr->WriteUtf8(info.GetIsolate(), &propName[0]);
-      SetInternal(propName, value, info);
+      SetInternal(v8::Local<v8::String>::Cast(v8PropName), value, info);
     }
 
     static void SetIndexed(
         uint32_t index,
         v8::Local<v8::Value> value,
         const v8::PropertyCallbackInfo<v8::Value> &info) {
-      std::string propName = std::to_string(index);
-      SetInternal(propName, value, info);
+      HostObjectProxy *hostObjectProxy = FromInfo(info);
+
+      if (hostObjectProxy == nullptr)
+        std::abort();
+
+      if (!hostObjectProxy->indexedHostObject_) {
+        SetInternal(IndexToString(info.GetIsolate(), index), value, info);
+        return;
+      }
+
+      V8Runtime &runtime = hostObjectProxy->runtime_;
+      ScopeSuspension suspension(runtime);
+      std::shared_ptr<facebook::jsi::HostObject> hostObject =
+          hostObjectProxy->hostObject_;
+
+      try {
+        hostObjectProxy->indexedHostObject_->setIndex(
+            runtime, index, runtime.createValue(value, true /*isLocal*/));
+      } catch (...) {
+        RethrowToJS(runtime, info.GetIsolate());
+        return;
+      }
+
+      // Mark the store as intercepted so it doesn't land on the wrapper.
+      info.GetReturnValue().Set(value);
+    }
+
+    // Callbacks of the accessors and methods created by createHostObjectClass.
+    // Their signature guarantees that Holder() is an instance of the class,
+    // and their data is the declaration in the class's description.
+    static void ClassGetter(const v8::FunctionCallbackInfo<v8::Value> &info) {
+      auto property =
+          static_cast<const HostObjectClassDescription::Property *>(
+              v8::Local<v8::External>::Cast(info.Data())->Value());
+      HostObjectProxy *hostObjectProxy = FromHolder(info.Holder());
+      std::shared_ptr<facebook::jsi::HostObject> hostObject =
+          hostObjectProxy->hostObject_;
+      if (!hostObject)
+        return;
+
+      V8Runtime &runtime = hostObjectProxy->runtime_;
+      ScopeSuspension suspension(runtime);
+
+      facebook::jsi::Value result;
+      try {
+        result = property->get(runtime, *hostObject);
+      } catch (...) {
+        RethrowToJS(runtime, info.GetIsolate());
+        return;
+      }
+
+      info.GetReturnValue().Set(runtime.valueRef(result));
+    }
+
+    static void ClassSetter(const v8::FunctionCallbackInfo<v8::Value> &info) {
+      auto property =
+          static_cast<const HostObjectClassDescription::Property *>(
+              v8::Local<v8::External>::Cast(info.Data())->Value());
+      HostObjectProxy *hostObjectProxy = FromHolder(info.Holder());
+      std::shared_ptr<facebook::jsi::HostObject> hostObject =
+          hostObjectProxy->hostObject_;
+      if (!hostObject)
+        return;
+
+      V8Runtime &runtime = hostObjectProxy->runtime_;
+      ScopeSuspension suspension(runtime);
+
+      try {
+        property->set(
+            runtime, *hostObject, runtime.createValue(info[0], true /*isLocal*/));
+      } catch (...) {
+        RethrowToJS(runtime, info.GetIsolate());
+      }
+    }
+
+    static void ClassMethod(const v8::FunctionCallbackInfo<v8::Value> &info) {
+      auto method = static_cast<const HostObjectClassDescription::Function *>(
+          v8::Local<v8::External>::Cast(info.Data())->Value());
+      HostObjectProxy *hostObjectProxy = FromHolder(info.Holder());
+      std::shared_ptr<facebook::jsi::HostObject> hostObject =
+          hostObjectProxy->hostObject_;
+      if (!hostObject)
+        return;
+
+      V8Runtime &runtime = hostObjectProxy->runtime_;
+      ScopeSuspension suspension(runtime);
+
+      // As in HostFunctionProxy::call.
+      const int argCount = info.Length();
+      facebook::jsi::Value inlineArgs[HostFunctionProxy::kMaxInlineArgs];
+      std::vector<facebook::jsi::Value> heapArgs;
+      facebook::jsi::Value *args = inlineArgs;
+      if (argCount > HostFunctionProxy::kMaxInlineArgs) {
+        heapArgs.resize(argCount);
+        args = heapArgs.data();
+      }
+
+      for (int i = 0; i < argCount; i++) {
+        args[i] = runtime.createValue(info[i], true /*isLocal*/);
+      }
+
+      facebook::jsi::Value result;
+      try {
+        result = method->call(runtime, *hostObject, args, argCount);
+      } catch (...) {
+        RethrowToJS(runtime, info.GetIsolate());
+        return;
+      }
+
+      info.GetReturnValue().Set(runtime.valueRef(result));
     }
 
     static void Enumerator(const v8::PropertyCallbackInfo<v8::Array> &info) {
-      v8::Local<v8::External> data = v8::Local<v8::External>::Cast(info.This()->GetInternalField(0));
-      HostObjectProxy *hostObjectProxy =
-          reinterpret_cast<HostObjectProxy *>(data->Value());
+      HostObjectProxy *hostObjectProxy = FromInfo(info);
 
       if (hostObjectProxy != nullptr) {
         V8Runtime &runtime = hostObjectProxy->runtime_;
+        ScopeSuspension suspension(runtime);
         std::shared_ptr<facebook::jsi::HostObject> hostObject =
             hostObjectProxy->hostObject_;
 
@@ -376,10 +816,44 @@ class V8Runtime : public facebook::jsi::Runtime {
       }
     }
 
+    // Reports 0..length-1 for IndexedHostObjects. Plain HostObjects report
+    // their indices through getPropertyNames, so nothing is added for them.
+    static void IndexedEnumerator(
+        const v8::PropertyCallbackInfo<v8::Array> &info) {
+      HostObjectProxy *hostObjectProxy = FromInfo(info);
+
+      if (hostObjectProxy == nullptr || !hostObjectProxy->indexedHostObject_) {
+        info.GetReturnValue().Set(v8::Array::New(info.GetIsolate()));
+        return;
+      }
+
+      V8Runtime &runtime = hostObjectProxy->runtime_;
+      ScopeSuspension suspension(runtime);
+      std::shared_ptr<facebook::jsi::HostObject> hostObject =
+          hostObjectProxy->hostObject_;
+
+      uint32_t length = hostObjectProxy->indexedHostObject_->length(runtime);
+      v8::Local<v8::Array> result =
+          v8::Array::New(info.GetIsolate(), static_cast<int>(length));
+      v8::Local<v8::Context> context = info.GetIsolate()->GetCurrentContext();
+
+      for (uint32_t i = 0; i < length; i++) {
+        if (!result->Set(context, i, v8::Integer::NewFromUnsigned(info.GetIsolate(), i))
+                 .FromJust()) {
+          std::terminate();
+        }
+      }
+
+      info.GetReturnValue().Set(result);
+    }
+
     HostObjectProxy(
         V8Runtime &rt,
-        const std::shared_ptr<facebook::jsi::HostObject> &hostObject)
-        : runtime_(rt), hostObject_(hostObject) {}
+        const std::shared_ptr<facebook::jsi::HostObject> &hostObject,
+        IndexedHostObject *indexedHostObject = nullptr)
+        : runtime_(rt),
+          hostObject_(hostObject),
+          indexedHostObject_(indexedHostObject) {}
     std::shared_ptr<facebook::jsi::HostObject> getHostObject() {
       return hostObject_;
     }
@@ -387,34 +861,67 @@ class V8Runtime : public facebook::jsi::Runtime {
    private:
     friend class HostObjectLifetimeTracker;
     void destroy() override {
+      indexedHostObject_ = nullptr;
       hostObject_.reset();
     }
 
+    static HostObjectProxy *FromHolder(v8::Local<v8::Object> holder) {
+      return reinterpret_cast<HostObjectProxy *>(
+          v8::Local<v8::External>::Cast(holder->GetInternalField(0))->Value());
+    }
+
+    static v8::Local<v8::String> IndexToString(
+        v8::Isolate *isolate,
+        uint32_t index) {
+      std::string propName = std::to_string(index);
+      return v8::String::NewFromOneByte(
+                 isolate,
+                 reinterpret_cast<const uint8_t *>(propName.c_str()),
+                 v8::NewStringType::kNormal,
+                 static_cast<int>(propName.length()))
+          .ToLocalChecked();
+    }
+
     V8Runtime &runtime_;
     std::shared_ptr<facebook::jsi::HostObject> hostObject_;
+
+    // Set when hostObject_ was created through createIndexedHostObject.
+    IndexedHostObject *indexedHostObject_;
   };
 
   class HostFunctionProxy : public IHostProxy {
    public:
+    // Calls with up to this many arguments don't allocate an argument array.
+    static constexpr int kMaxInlineArgs = 8;
+
     static void call(
         HostFunctionProxy &hostFunctionProxy,
         const v8::FunctionCallbackInfo<v8::Value> &callbackInfo) {
       V8Runtime &runtime = const_cast<V8Runtime &>(hostFunctionProxy.runtime_);
       v8::Isolate *isolate = callbackInfo.GetIsolate();
+      ScopeSuspension suspension(runtime);
+
+      // The arguments and this only live for the duration of the call, so they
+      // borrow the callback's locals rather than creating global handles.
+      const int argCount = callbackInfo.Length();
+      facebook::jsi::Value inlineArgs[kMaxInlineArgs];
+      std::vector<facebook::jsi::Value> heapArgs;
+      facebook::jsi::Value *args = inlineArgs;
+      if (argCount > kMaxInlineArgs) {
+        heapArgs.resize(argCount);
+        args = heapArgs.data();
+      }
 
-      std::vector<facebook::jsi::Value> argsVector;
-      for (int i = 0; i < callbackInfo.Length(); i++) {
-        argsVector.push_back(
-            hostFunctionProxy.runtime_.createValue(callbackInfo[i]));
+      for (int i = 0; i < argCount; i++) {
+        args[i] = runtime.createValue(callbackInfo[i], true /*isLocal*/);
       }
 
       const facebook::jsi::Value &thisVal =
-          runtime.createValue(callbackInfo.This());
+          runtime.createValue(callbackInfo.This(), true /*isLocal*/);
 
       facebook::jsi::Value result;
       try {
-        result = hostFunctionProxy.func_(
-            runtime, thisVal, argsVector.data(), callbackInfo.Length());
+        result = hostFunctionProxy.func_(runtime, thisVal, args, argCount);
       } catch (const facebook::jsi::JSError &error) {
         callbackInfo.GetReturnValue().Set(v8::Undefined(isolate));
 
@@ -450,9 +957,9 @@ class V8Runtime : public facebook::jsi::Runtime {
     }
 
    public:
+    // V8 already provides a HandleScope around function callbacks.
     static void HostFunctionCallback(
         const v8::FunctionCallbackInfo<v8::Value> &info) {
-      v8::HandleScope handle_scope(v8::Isolate::GetCurrent());
       v8::Local<v8::External> data = v8::Local<v8::External>::Cast(info.Data());
       HostFunctionProxy *hostFunctionProxy =
           reinterpret_cast<HostFunctionProxy *>(data->Value());
@@ -475,38 +982,135 @@ class V8Runtime : public facebook::jsi::Runtime {
     V8Runtime &runtime_;
   };
 
-  template<typename T>
+  class V8PointerValueTable;
+
+  // A jsi PointerValue backed by a slot in the runtime's V8PointerValueTable.
+  // Slots are recycled rather than freed, so invalidate() only drops the
+  // handle and puts the slot back on the free list.
   class V8PointerValue final : public PointerValue {
-    static V8PointerValue<T>* make(v8::Local<T> objectRef) {
-      return new V8PointerValue<T>(objectRef);
+   public:
+    V8PointerValue() = default;
+
+    ~V8PointerValue() {
+      handle_.Reset();
     }
 
-    V8PointerValue(v8::Local<T> obj) :
-      v8Object_(v8::Isolate::GetCurrent(), obj)
-    {}
+    void invalidate() override;
 
-    ~V8PointerValue() {
-      v8Object_.Reset();
+    // Moves a value backed by a jsi::Scope's local to a global handle, for
+    // values that outlive the scope.
+    void promote(v8::Isolate *isolate) {
+      if (!local_.IsEmpty()) {
+        handle_.Reset(isolate, local_);
+        local_.Clear();
+      }
     }
 
-    void invalidate() override {
-      delete this;
+    // Used for WeakObject: once the object is collected, get returns an empty
+    // Local.
+    void makeWeak() {
+      handle_.SetWeak();
     }
 
-    v8::Local<T> get(v8::Isolate* isolate) const {
-      return v8Object_.Get(isolate);
+    template <typename T>
+    v8::Local<T> get(v8::Isolate *isolate) const {
+      if (!local_.IsEmpty())
+        return local_.As<T>();
+      return v8::Local<v8::Value>::New(isolate, handle_).As<T>();
     }
 
    private:
-    v8::Persistent<T> v8Object_;
+    V8PointerValue(const V8PointerValue &) = delete;
+    V8PointerValue &operator=(const V8PointerValue &) = delete;
 
-   protected:
-    friend class V8Runtime;
+    v8::Global<v8::Value> handle_;
+
+    // Used instead of handle_ for values that never outlive the HandleScope
+    // they were created in, see V8PointerValueTable::allocateLocal.
+    v8::Local<v8::Value> local_;
+    V8PointerValueTable *table_{nullptr};
+    V8PointerValue *next_free_{nullptr};
+
+    friend class V8PointerValueTable;
   };
 
-  using V8StringValue = V8PointerValue<v8::String>;
-  using V8ObjectValue = V8PointerValue<v8::Object>;
+  // Per-runtime slab storage for V8PointerValues. Slabs are never returned to
+  // the heap before the runtime goes away; released slots are chained into a
+  // free list and handed out again by allocate().
+  class V8PointerValueTable {
+   public:
+    V8PointerValueTable() = default;
+
+    V8PointerValue *allocate(v8::Isolate *isolate, v8::Local<v8::Value> value) {
+      if (free_list_ == nullptr)
+        grow();
+
+      V8PointerValue *pv = free_list_;
+      free_list_ = pv->next_free_;
+      pv->next_free_ = nullptr;
+      pv->handle_.Reset(isolate, value);
+      ++live_count_;
+      return pv;
+    }
+
+    // Borrows the Local instead of creating a global handle. The value must be
+    // released before the enclosing HandleScope goes away, which holds for
+    // the arguments of a host function call for instance.
+    V8PointerValue *allocateLocal(v8::Local<v8::Value> value) {
+      if (free_list_ == nullptr)
+        grow();
+
+      V8PointerValue *pv = free_list_;
+      free_list_ = pv->next_free_;
+      pv->next_free_ = nullptr;
+      pv->local_ = value;
+      ++live_count_;
+      return pv;
+    }
 
+    void release(V8PointerValue *pv) {
+      pv->handle_.Reset();
+      pv->local_.Clear();
+      pv->next_free_ = free_list_;
+      free_list_ = pv;
+      --live_count_;
+    }
+
+    size_t liveCount() const {
+      return live_count_;
+    }
+
+    // Drops every handle still held by the table. Must run while the isolate
+    // is alive.
+    void clear() {
+      slabs_.clear();
+      free_list_ = nullptr;
+      live_count_ = 0;
+    }
+
+   private:
+    V8PointerValueTable(const V8PointerValueTable &) = delete;
+    V8PointerValueTable &operator=(const V8PointerValueTable &) = delete;
+
+    static constexpr size_t kSlabSize = 256;
+
+    void grow() {
+      std::unique_ptr<V8PointerValue[]> slab(new V8PointerValue[kSlabSize]);
+      for (size_t i = kSlabSize; i-- > 0;) {
+        slab[i].table_ = this;
+        slab[i].next_free_ = free_list_;
+        free_list_ = &slab[i];
+      }
+      slabs_.push_back(std::move(slab));
+    }
+
+    std::vector<std::unique_ptr<V8PointerValue[]>> slabs_;
+    V8PointerValue *free_list_{nullptr};
+    size_t live_count_{0};
+  };
+
+  // Keeps the source buffer alive until V8 disposes of the external string,
+  // which deletes the resource.
   class ExternalOwningOneByteStringResource
       : public v8::String::ExternalOneByteStringResource {
    public:
@@ -524,6 +1128,19 @@ class V8Runtime : public facebook::jsi::Runtime {
     std::shared_ptr<const facebook::jsi::Buffer> buffer_;
   };
 
+  // Smaller scripts are simply copied.
+  static constexpr size_t kMinExternalSourceLength = 1024;
+
+  // Creates the source string for a script, referencing buffer rather than
+  // copying it when possible.
+  v8::Local<v8::String> CreateSourceString(
+      const std::shared_ptr<const facebook::jsi::Buffer> &buffer);
+
+  // Returns the internalized string for a property name, going through
+  // prop_name_id_cache_ so that hot names are created and hashed only once.
+  v8::MaybeLocal<v8::String>
+  internPropName(const char *str, size_t length, bool isAscii);
+
   std::shared_ptr<const facebook::jsi::PreparedJavaScript> prepareJavaScript(
       const std::shared_ptr<const facebook::jsi::Buffer> &,
       std::string) override;
@@ -557,6 +1174,10 @@ class V8Runtime : public facebook::jsi::Runtime {
       override;
   std::string utf8(const facebook::jsi::String &) override;
 
+  facebook::jsi::Value createValueFromJsonUtf8(
+      const uint8_t *json,
+      size_t length) override;
+
   facebook::jsi::Object createObject() override;
   facebook::jsi::Object createObject(
       std::shared_ptr<facebook::jsi::HostObject> ho) override;
@@ -636,8 +1257,15 @@ class V8Runtime : public facebook::jsi::Runtime {
       const facebook::jsi::Object &o,
       const facebook::jsi::Function &f) override;
 
+  facebook::jsi::Object createHostObject(
+      std::shared_ptr<facebook::jsi::HostObject> hostObject,
+      IndexedHostObject *indexedHostObject,
+      v8::Local<v8::Function> constructor);
+
   void AddHostObjectLifetimeTracker(
       std::shared_ptr<HostObjectLifetimeTracker> hostObjectLifetimeTracker);
+  void RemoveHostObjectLifetimeTracker(
+      HostObjectLifetimeTracker *hostObjectLifetimeTracker);
 
   static void OnMessage(
       v8::Local<v8::Message> message,
@@ -680,12 +1308,27 @@ class V8Runtime : public facebook::jsi::Runtime {
   v8::Isolate *CreateNewIsolate();
   void createHostObjectConstructorPerContext();
 
-  // Basically convenience casts
+  PointerValue *makePointerValue(
+      v8::Local<v8::Value> value,
+      bool isLocal = false) const {
+    if (isLocal) {
+      return pointer_value_table_.allocateLocal(value);
+    }
+
+    if (current_scope_ != nullptr) {
+      V8PointerValue *pv = pointer_value_table_.allocateLocal(value);
+      current_scope_->locals.push_back(pv);
+      return pv;
+    }
+
+    return pointer_value_table_.allocate(GetIsolate(), value);
+  }
+
+  // Basically convenience casts. The returned Local lives in the caller's
+  // HandleScope.
   template<typename T>
   static v8::Local<T> pvRef(const PointerValue* pv) {
-    v8::EscapableHandleScope handle_scope(v8::Isolate::GetCurrent());
-    const V8PointerValue<T> *v8PValue = static_cast<const V8PointerValue<T>*>(pv);
-    return handle_scope.Escape(v8PValue->get(v8::Isolate::GetCurrent()));
+    return static_cast<const V8PointerValue *>(pv)->get<T>(v8::Isolate::GetCurrent());
   }
 
   static v8::Local<v8::String> stringRef(const facebook::jsi::String &str) { return pvRef<v8::String>(getPointerValue(str)); }
@@ -694,7 +1337,12 @@ class V8Runtime : public facebook::jsi::Runtime {
   static v8::Local<v8::Symbol> symbolRef(const facebook::jsi::Symbol &sym) { return pvRef<v8::Symbol>(getPointerValue(sym)); }
 
   v8::Local<v8::Value> valueRef(const facebook::jsi::Value &value);
-  facebook::jsi::Value createValue(v8::Local<v8::Value> value) const;
+  // With isLocal, strings, objects and symbols borrow the Local (see
+  // V8PointerValueTable::allocateLocal) and the result must not outlive the
+  // current HandleScope.
+  facebook::jsi::Value createValue(
+      v8::Local<v8::Value> value,
+      bool isLocal = false) const;
 
 #ifdef _WIN32
   std::unique_ptr<inspector::Agent> inspector_agent_;
@@ -705,14 +1353,52 @@ class V8Runtime : public facebook::jsi::Runtime {
   v8::Isolate *isolate_;
   v8::Global<v8::Context> context_;
 
+  // Used by context_ only, with the policy from args_. Owned by the
+  // IsolateData.
+  v8::MicrotaskQueue *microtask_queue_{nullptr};
+
+  // Number of JSI calls and EnterScope sessions currently entered on this
+  // runtime.
+  mutable uint32_t entered_depth_{0};
+
+  // Innermost jsi::Scope, unless suspended (see ScopeSuspension).
+  mutable HandleScopeState *current_scope_{nullptr};
+
+  // Popped scope states, reused so that a jsi::Scope in a loop doesn't
+  // allocate.
+  std::vector<std::unique_ptr<HandleScopeState>> scope_state_pool_;
+
   v8::StartupData startup_data_;
   v8::Isolate::CreateParams create_params_;
 
+  mutable V8PointerValueTable pointer_value_table_;
+
+  // Internalized property names keyed by their UTF-8 content. The cache is
+  // set-associative: a name can only be held by the ways of the set its hash
+  // selects, which are kept in most recently used order, so a miss on a full
+  // set evicts that set's least recently used name. Lookups compare the
+  // stored bytes in place and don't allocate. Allocated on first use.
+  struct PropNameIDCacheEntry {
+    uint64_t hash{0};
+    std::string name;
+    v8::Global<v8::String> value;
+  };
+  static constexpr size_t kPropNameIDCacheSets = 1024;
+  static constexpr size_t kPropNameIDCacheWays = 4;
+  std::unique_ptr<PropNameIDCacheEntry[]> prop_name_id_cache_;
+  size_t prop_name_id_cache_size_{0};
+  uint64_t prop_name_id_cache_hits_{0};
+  uint64_t prop_name_id_cache_misses_{0};
+
   v8::Persistent<v8::FunctionTemplate> host_function_template_;
+  v8::Persistent<v8::FunctionTemplate> host_object_template_;
   v8::Persistent<v8::Function> host_object_constructor_;
 
-  std::list<std::shared_ptr<HostObjectLifetimeTracker>>
-      host_object_lifetime_tracker_list_;
+  std::vector<std::unique_ptr<HostObjectClass>> host_object_classes_;
+
+  // One entry per live host object and host function; entries remove
+  // themselves when the object is garbage collected.
+  HostObjectLifetimeTrackerList host_object_lifetime_tracker_list_;
 
   std::string desc_;
 
@@ -721,9 +1407,6 @@ class V8Runtime : public facebook::jsi::Runtime {
   V8PlatformHolder platform_holder_;
   v8::StartupData custom_snapshot_startup_data_;
 
-  std::vector<std::unique_ptr<ExternalOwningOneByteStringResource>>
-      owned_external_string_resources_;
-
   std::shared_ptr<v8::TaskRunner> foreground_task_runner_;
 
   static CounterMap *counter_map_;
@@ -744,4 +1427,9 @@ class V8Runtime : public facebook::jsi::Runtime {
 
   static void JitCodeEventListener(const v8::JitCodeEvent *event);
 };
+
+inline void V8Runtime::V8PointerValue::invalidate() {
+  table_->release(this);
+}
+
 } // namespace v8runtime
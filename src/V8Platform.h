@@ -9,6 +9,7 @@
 #include <map>
 #include <mutex>
 #include <queue>
+#include <vector>
 #include "libplatform/libplatform.h"
 #include "v8.h"
 
@@ -21,6 +22,11 @@ constexpr int ISOLATE_DATA_SLOT = 0;
 // Platform needs to map every isolate to this data.
 struct IsolateData {
   std::shared_ptr<v8::TaskRunner> foreground_task_runner_;
+
+  // The runtimes' microtask queues. A context uses its queue until it is
+  // collected, which can be long after its runtime is gone when the isolate
+  // is shared, so they are only freed along with the isolate.
+  std::vector<std::unique_ptr<v8::MicrotaskQueue>> microtask_queues_;
 };
 
 class ETWTracingController : public v8::TracingController {
@@ -176,6 +176,25 @@ TEST_P(JSITest, ObjectTest) {
   EXPECT_EQ(names.getValueAtIndex(rt, 0).getString(rt).utf8(rt), "a");
 }
 
+TEST_P(JSITest, WeakObjectTest) {
+  Object obj = eval("({a: 1})").getObject(rt);
+  WeakObject weak(rt, obj);
+
+  // While obj holds a strong reference, lock yields the same object.
+  Value locked = weak.lock(rt);
+  ASSERT_TRUE(locked.isObject());
+  EXPECT_TRUE(Object::strictEquals(rt, locked.getObject(rt), obj));
+  EXPECT_EQ(locked.getObject(rt).getProperty(rt, "a").getNumber(), 1);
+
+  // The locked value is a strong reference of its own.
+  Object strong = std::move(locked).getObject(rt);
+  obj = Object(rt);
+  EXPECT_TRUE(Object::strictEquals(rt, weak.lock(rt).getObject(rt), strong));
+
+  WeakObject moved = std::move(weak);
+  EXPECT_TRUE(moved.lock(rt).isObject());
+}
+
 TEST_P(JSITest, HostObjectTest) {
   class ConstantHostObject : public HostObject {
     Value get(Runtime&, const PropNameID& sym) override {
@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+#pragma once
+
+#include <jsi/jsi.h>
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "V8JsiRuntime.h"
+
+// Host functions written as C++20 coroutines. A coroutine returning AsyncValue
+// runs on the JS thread until its first suspension, and its caller gets a
+// promise, settled through createPromiseResolver when the coroutine finishes:
+// resolved with the co_returned value, or rejected with the exception that
+// escaped it.
+//
+// The coroutine must always be resumed on the runtime's thread; it is up to
+// its awaitables to get back there, e.g. through the runtime's task runner.
+//
+// Header only, and empty unless the compiler supports coroutines.
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define V8JSI_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifdef V8JSI_HAS_COROUTINES
+
+namespace v8runtime {
+
+class AsyncValue {
+ public:
+  class promise_type {
+   public:
+    // The coroutine's first parameter must be the runtime. The second
+    // constructor is for member functions and lambdas, whose object comes
+    // first.
+    template <typename... Args>
+    promise_type(facebook::jsi::Runtime &runtime, const Args &...)
+        : runtime_(runtime), resolver_(createPromiseResolver(runtime)) {}
+    template <typename Self, typename... Args>
+    promise_type(const Self &, facebook::jsi::Runtime &runtime, const Args &...)
+        : runtime_(runtime), resolver_(createPromiseResolver(runtime)) {}
+
+    AsyncValue get_return_object() {
+      return AsyncValue(getPromise(runtime_, resolver_));
+    }
+
+    std::suspend_never initial_suspend() noexcept {
+      return {};
+    }
+
+    // The frame goes away on completion; the promise carries the result.
+    std::suspend_never final_suspend() noexcept {
+      return {};
+    }
+
+    void return_value(facebook::jsi::Value value) {
+      resolvePromise(runtime_, resolver_, value);
+    }
+
+    void unhandled_exception() {
+      try {
+        throw;
+      } catch (const facebook::jsi::JSError &error) {
+        rejectPromise(runtime_, resolver_, error.value());
+      } catch (const std::exception &ex) {
+        reject(ex.what());
+      } catch (...) {
+        reject("Exception in async host function: <unknown>");
+      }
+    }
+
+   private:
+    void reject(const char *message) {
+      facebook::jsi::Function error =
+          runtime_.global().getPropertyAsFunction(runtime_, "Error");
+      rejectPromise(
+          runtime_,
+          resolver_,
+          error.callAsConstructor(
+              runtime_,
+              facebook::jsi::String::createFromUtf8(runtime_, message)));
+    }
+
+    facebook::jsi::Runtime &runtime_;
+    facebook::jsi::Object resolver_;
+  };
+
+  // The promise for the coroutine's result.
+  facebook::jsi::Object &promise() {
+    return promise_;
+  }
+
+ private:
+  explicit AsyncValue(facebook::jsi::Object promise)
+      : promise_(std::move(promise)) {}
+
+  facebook::jsi::Object promise_;
+};
+
+// Arguments are passed by value, so that they outlive the call and stay valid
+// across suspensions.
+using AsyncHostFunctionType = std::function<AsyncValue(
+    facebook::jsi::Runtime &runtime,
+    facebook::jsi::Value thisVal,
+    std::vector<facebook::jsi::Value> args)>;
+
+// Like Function::createFromHostFunction, for coroutines. Calls return the
+// coroutine's promise.
+inline facebook::jsi::Function createAsyncHostFunction(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::PropNameID &name,
+    unsigned int paramCount,
+    AsyncHostFunctionType func) {
+  auto shared = std::make_shared<AsyncHostFunctionType>(std::move(func));
+  return facebook::jsi::Function::createFromHostFunction(
+      runtime,
+      name,
+      paramCount,
+      [shared](
+          facebook::jsi::Runtime &rt,
+          const facebook::jsi::Value &thisVal,
+          const facebook::jsi::Value *args,
+          size_t count) -> facebook::jsi::Value {
+        std::vector<facebook::jsi::Value> argsCopy;
+        argsCopy.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+          argsCopy.emplace_back(rt, args[i]);
+        }
+
+        AsyncValue result =
+            (*shared)(rt, facebook::jsi::Value(rt, thisVal), std::move(argsCopy));
+        return std::move(result.promise());
+      });
+}
+
+} // namespace v8runtime
+
+#endif // V8JSI_HAS_COROUTINES
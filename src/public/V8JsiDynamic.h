@@ -0,0 +1,153 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+#pragma once
+
+#include <folly/dynamic.h>
+#include <jsi/jsi.h>
+
+#include <string>
+#include <vector>
+
+#include "V8JsiRuntime.h"
+
+// V8 specialized counterparts of jsi::valueFromDynamic and
+// jsi::dynamicFromValue (see jsi/JSIDynamic.h) producing the same results.
+// The JS side of the conversion happens inside the engine through
+// buildValueTree and visitValueTree, instead of one JSI call per node.
+//
+// Header only, so that v8jsi itself doesn't depend on folly.
+
+namespace v8runtime {
+namespace detail {
+
+inline void produceDynamic(
+    ValueTreeVisitor &visitor,
+    const folly::dynamic &dyn) {
+  switch (dyn.type()) {
+    case folly::dynamic::NULLT:
+      visitor.null();
+      break;
+    case folly::dynamic::ARRAY:
+      visitor.beginArray(dyn.size());
+      for (const auto &element : dyn) {
+        produceDynamic(visitor, element);
+      }
+      visitor.endArray();
+      break;
+    case folly::dynamic::BOOL:
+      visitor.boolean(dyn.getBool());
+      break;
+    case folly::dynamic::DOUBLE:
+      visitor.number(dyn.getDouble());
+      break;
+    case folly::dynamic::INT64:
+      // Not asDouble(), which throws for integers a double can't represent
+      // precisely.
+      visitor.number(static_cast<double>(dyn.getInt()));
+      break;
+    case folly::dynamic::OBJECT:
+      visitor.beginObject();
+      for (const auto &element : dyn.items()) {
+        if (element.first.isNumber() || element.first.isString()) {
+          const std::string key = element.first.asString();
+          visitor.key(key.data(), key.size());
+          produceDynamic(visitor, element.second);
+        }
+      }
+      visitor.endObject();
+      break;
+    case folly::dynamic::STRING: {
+      const std::string &str = dyn.getString();
+      visitor.string(str.data(), str.size());
+      break;
+    }
+  }
+}
+
+// Collects a visited value tree into a folly::dynamic. A container is added to
+// its parent when it begins; its parent isn't modified again until it ends,
+// so the pointers on the stack stay valid.
+class DynamicCollector : public ValueTreeVisitor {
+ public:
+  void null() override {
+    add(nullptr);
+  }
+
+  void boolean(bool value) override {
+    add(value);
+  }
+
+  void number(double value) override {
+    add(value);
+  }
+
+  void string(const char *utf8, size_t length) override {
+    add(std::string(utf8, length));
+  }
+
+  void beginArray(size_t length) override {
+    folly::dynamic &array = add(folly::dynamic::array());
+    array.reserve(length);
+    stack_.push_back(&array);
+  }
+
+  void endArray() override {
+    stack_.pop_back();
+  }
+
+  void beginObject() override {
+    stack_.push_back(&add(folly::dynamic::object()));
+  }
+
+  void key(const char *utf8, size_t length) override {
+    key_.assign(utf8, length);
+  }
+
+  void endObject() override {
+    stack_.pop_back();
+  }
+
+  folly::dynamic &result() {
+    return result_;
+  }
+
+ private:
+  folly::dynamic &add(folly::dynamic value) {
+    if (stack_.empty()) {
+      result_ = std::move(value);
+      return result_;
+    }
+
+    folly::dynamic &container = *stack_.back();
+    if (container.isArray()) {
+      container.push_back(std::move(value));
+      return container[container.size() - 1];
+    }
+
+    return container[key_] = std::move(value);
+  }
+
+  folly::dynamic result_;
+  std::vector<folly::dynamic *> stack_;
+  std::string key_;
+};
+
+} // namespace detail
+
+inline facebook::jsi::Value valueFromDynamic(
+    facebook::jsi::Runtime &runtime,
+    const folly::dynamic &dyn) {
+  return buildValueTree(runtime, [&dyn](ValueTreeVisitor &visitor) {
+    detail::produceDynamic(visitor, dyn);
+  });
+}
+
+inline folly::dynamic dynamicFromValue(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Value &value) {
+  detail::DynamicCollector collector;
+  visitValueTree(runtime, value, collector);
+  return std::move(collector.result());
+}
+
+} // namespace v8runtime
@@ -3,7 +3,9 @@
 #pragma once
 
 #include <jsi/jsi.h>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace facebook {
 namespace jsi {
@@ -17,6 +19,7 @@ struct ScriptStore;
 namespace v8 {
 template <class T>
 class Local;
+class CFunction;
 class Context;
 class Platform;
 class Isolate;
@@ -57,6 +60,15 @@ enum class LogLevel {
 
 using Logger = std::function<void(const char *message, LogLevel logLevel)>;
 
+// When the runtime's microtasks, e.g. promise continuations, run.
+enum class MicrotasksPolicy {
+  // Whenever the outermost call into JS returns, including every JSI call.
+  Auto,
+  // Only in drainMicrotasks, so that many calls into JS can share one
+  // checkpoint, e.g. at the end of each event loop turn.
+  Explicit,
+};
+
 struct V8RuntimeArgs {
   std::shared_ptr<Logger> logger;
 
@@ -84,6 +96,21 @@ struct V8RuntimeArgs {
   bool enableLog{false};
   bool enableGCTracing{false};
 
+  // Installs gc() on the global object (--expose-gc), for tests.
+  bool exposeGC{false};
+
+  // Enables V8's %-prefixed runtime functions in script
+  // (--allow-natives-syntax), for tests.
+  bool allowNativesSyntax{false};
+
+  // Lets optimized code call the fastFunction of functions created by
+  // createFunctionFromHostFunction directly (--turbo-fast-api-calls). Like
+  // the other V8 flags, this applies to the whole process.
+  bool enableFastApiCalls{false};
+
+  // Each runtime has its own microtask queue, even when sharing an isolate.
+  MicrotasksPolicy microtasksPolicy{MicrotasksPolicy::Auto};
+
   bool enableInspector{false};
   bool waitForDebugger{false};
 
@@ -96,11 +123,394 @@ struct V8RuntimeArgs {
 
 #ifdef BUILDING_V8_SHARED
 #ifdef _WIN32
-__declspec(dllexport)
+#define V8JSI_EXPORT __declspec(dllexport)
 #else
-__attribute__((visibility("default")))
+#define V8JSI_EXPORT __attribute__((visibility("default")))
 #endif
+#else
+#define V8JSI_EXPORT
 #endif
-std::unique_ptr<facebook::jsi::Runtime> __cdecl makeV8Runtime(V8RuntimeArgs &&args);
+
+V8JSI_EXPORT std::unique_ptr<facebook::jsi::Runtime> __cdecl makeV8Runtime(V8RuntimeArgs &&args);
+
+// The functions below extend the JSI surface with V8 specific entry points.
+// The runtime passed to them must have been created by makeV8Runtime.
+
+// Keeps the runtime's isolate and context entered until the matching
+// exitScope. JSI calls made in between skip their own isolate/context setup.
+// Calls must be balanced and made on the runtime's thread; prefer EnterScope.
+V8JSI_EXPORT void __cdecl enterScope(facebook::jsi::Runtime &runtime);
+V8JSI_EXPORT void __cdecl exitScope(facebook::jsi::Runtime &runtime);
+
+struct V8RuntimeStats {
+  // PropNameIDs created from ASCII/UTF-8 that were served from, or had to be
+  // added to, the runtime's internalized name cache.
+  uint64_t propNameIDCacheHits{0};
+  uint64_t propNameIDCacheMisses{0};
+  size_t propNameIDCacheSize{0};
+
+  // Host objects and host functions that haven't been garbage collected yet.
+  size_t liveHostObjectTrackers{0};
+};
+
+V8JSI_EXPORT V8RuntimeStats __cdecl getRuntimeStats(facebook::jsi::Runtime &runtime);
+
+// Runs the runtime's pending microtasks, including the ones they queue, and
+// returns true once the queue is empty. It has no effect while microtasks are
+// already running. Same contract as drainMicrotasks in newer JSI versions;
+// V8 always drains the whole queue, so maxMicrotasksHint is ignored.
+V8JSI_EXPORT bool __cdecl drainMicrotasks(
+    facebook::jsi::Runtime &runtime,
+    int maxMicrotasksHint = -1);
+
+// HostObject that is also addressed by integer indices, for list and buffer
+// like objects. When created through createIndexedHostObject, integer keyed
+// accesses from JS go to getIndex/setIndex without being turned into property
+// names; everything else still goes through get/set/getPropertyNames.
+class IndexedHostObject : public facebook::jsi::HostObject {
+ public:
+  // Only called for index < length().
+  virtual facebook::jsi::Value getIndex(
+      facebook::jsi::Runtime &runtime,
+      uint32_t index) = 0;
+
+  // Called for any index, including ones at or past length().
+  virtual void setIndex(
+      facebook::jsi::Runtime &runtime,
+      uint32_t index,
+      const facebook::jsi::Value &value) = 0;
+
+  // Bounds the readable and enumerated indices. Note that it is not exposed
+  // as a "length" property unless get() does so.
+  virtual uint32_t length(facebook::jsi::Runtime &runtime) = 0;
+};
+
+V8JSI_EXPORT facebook::jsi::Object __cdecl createIndexedHostObject(
+    facebook::jsi::Runtime &runtime,
+    std::shared_ptr<IndexedHostObject> hostObject);
+
+// Creates a pending promise and returns its resolver, for native code to
+// settle later through resolvePromise or rejectPromise. This avoids looking up
+// the Promise constructor and capturing its resolve/reject functions through
+// JSI. Only the first settlement counts. Resolving with a promise or thenable
+// adopts its state, as in JS.
+V8JSI_EXPORT facebook::jsi::Object __cdecl createPromiseResolver(
+    facebook::jsi::Runtime &runtime);
+
+// The promise to hand out to JS for a resolver from createPromiseResolver.
+V8JSI_EXPORT facebook::jsi::Object __cdecl getPromise(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Object &resolver);
+
+V8JSI_EXPORT void __cdecl resolvePromise(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Object &resolver,
+    const facebook::jsi::Value &value);
+V8JSI_EXPORT void __cdecl rejectPromise(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Object &resolver,
+    const facebook::jsi::Value &reason);
+
+// Like Function::createFromHostFunction, with fastFunction as an additional
+// entry point that optimized code can call directly, with unboxed primitive
+// arguments (see v8-fast-api-calls.h). It must behave like func, which is
+// still used by unoptimized code and whenever V8 can't take the fast path,
+// and when enableFastApiCalls is off. fastFunction may be null.
+//
+// With a fastFunction, the function is instantiated from its own
+// FunctionTemplate, and the context caches the result until it is disposed:
+// the function, func and whatever func captures are never collected. Only
+// use it for long-lived registrations, such as helpers installed once at
+// startup. Without one, the function is collected like any other.
+V8JSI_EXPORT facebook::jsi::Function __cdecl createFunctionFromHostFunction(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::PropNameID &name,
+    unsigned int paramCount,
+    facebook::jsi::HostFunctionType func,
+    const v8::CFunction *fastFunction);
+
+// Fixed set of properties and methods shared by a class of host objects, see
+// createHostObjectClass. The callbacks receive the instance's HostObject.
+struct HostObjectClassDescription {
+  using Getter = std::function<facebook::jsi::Value(
+      facebook::jsi::Runtime &runtime,
+      facebook::jsi::HostObject &hostObject)>;
+  using Setter = std::function<void(
+      facebook::jsi::Runtime &runtime,
+      facebook::jsi::HostObject &hostObject,
+      const facebook::jsi::Value &value)>;
+  using Method = std::function<facebook::jsi::Value(
+      facebook::jsi::Runtime &runtime,
+      facebook::jsi::HostObject &hostObject,
+      const facebook::jsi::Value *args,
+      size_t count)>;
+
+  struct Property {
+    std::string name;
+    Getter get;
+    // Read only if not set.
+    Setter set;
+  };
+
+  struct Function {
+    std::string name;
+    unsigned int paramCount;
+    Method call;
+  };
+
+  // Reported as the constructor name, e.g. by the inspector.
+  std::string className;
+  std::vector<Property> properties;
+  std::vector<Function> methods;
+};
+
+// Owned by the runtime that created it.
+class HostObjectClass;
+
+// Materializes description once, as accessor properties and functions on a
+// prototype shared by all instances of the class. Unlike createObject, whose
+// host objects intercept every property access, V8 can cache lookups of the
+// declared names, and other names never call into native code.
+V8JSI_EXPORT HostObjectClass *__cdecl createHostObjectClass(
+    facebook::jsi::Runtime &runtime,
+    HostObjectClassDescription description);
+
+// Creates an instance of hostObjectClass backed by hostObject. Only the
+// class's callbacks are used; hostObject's get, set and getPropertyNames are
+// not called, and other properties set from JS are stored on the object
+// itself. isHostObject and getHostObject work as for createObject.
+V8JSI_EXPORT facebook::jsi::Object __cdecl createHostObject(
+    facebook::jsi::Runtime &runtime,
+    HostObjectClass *hostObjectClass,
+    std::shared_ptr<facebook::jsi::HostObject> hostObject);
+
+// Creates an ArrayBuffer over size bytes at data without copying them; JS
+// reads and writes go straight to that memory. deleter is called once V8 no
+// longer uses the memory, which can happen on a background thread or when the
+// runtime is destroyed.
+V8JSI_EXPORT facebook::jsi::ArrayBuffer __cdecl createExternalArrayBuffer(
+    facebook::jsi::Runtime &runtime,
+    uint8_t *data,
+    size_t size,
+    std::function<void(uint8_t *)> deleter);
+
+// Creates an ArrayBuffer holding a copy of buffer's contents. jsi::Buffer
+// data is read only (e.g. a read only mapped file or a string literal) while
+// JS can always write to an ArrayBuffer, so the memory can't be shared; use
+// createExternalArrayBuffer for writable host memory.
+V8JSI_EXPORT facebook::jsi::ArrayBuffer __cdecl createArrayBuffer(
+    facebook::jsi::Runtime &runtime,
+    std::shared_ptr<const facebook::jsi::Buffer> buffer);
+
+enum class TypedArrayKind {
+  Int8Array,
+  Uint8Array,
+  Uint8ClampedArray,
+  Int16Array,
+  Uint16Array,
+  Int32Array,
+  Uint32Array,
+  Float32Array,
+  Float64Array,
+  BigInt64Array,
+  BigUint64Array,
+};
+
+// Creates a typed array of kind viewing length elements of buffer, starting
+// at byteOffset, without copying them. Together with createExternalArrayBuffer
+// this exposes host memory to JS directly. byteOffset must be a multiple of
+// the element size and the view must fit in buffer, else JSINativeException
+// is thrown.
+V8JSI_EXPORT facebook::jsi::Object __cdecl createTypedArray(
+    facebook::jsi::Runtime &runtime,
+    TypedArrayKind kind,
+    const facebook::jsi::ArrayBuffer &buffer,
+    size_t byteOffset,
+    size_t length);
+
+// Creates a typed array of kind with length elements in memory owned by the
+// engine, filled with a copy of data, or with zeros if data is null.
+V8JSI_EXPORT facebook::jsi::Object __cdecl createTypedArray(
+    facebook::jsi::Runtime &runtime,
+    TypedArrayKind kind,
+    const void *data,
+    size_t length);
+
+struct TypedArrayData {
+  TypedArrayKind kind;
+  // The first element of the view, in the ArrayBuffer's backing store, so
+  // writes are visible to JS. Stays valid while the buffer isn't detached.
+  uint8_t *data;
+  size_t length;
+  size_t byteLength;
+};
+
+// Returns false if object is not a typed array, else fills out with direct
+// access to its elements.
+V8JSI_EXPORT bool __cdecl getTypedArrayData(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Object &object,
+    TypedArrayData &out);
+
+// UTF-16 counterparts of String::createFromUtf8 and String::utf8, for hosts
+// whose strings are UTF-16 already. They map directly onto V8's two-byte
+// string representation, avoiding a round trip through UTF-8 on either side.
+V8JSI_EXPORT facebook::jsi::String __cdecl createStringFromUtf16(
+    facebook::jsi::Runtime &runtime,
+    const char16_t *utf16,
+    size_t length);
+V8JSI_EXPORT std::u16string __cdecl utf16(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::String &str);
+
+// Like utf16, but appends to out so that its capacity can be reused.
+V8JSI_EXPORT void __cdecl appendUtf16(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::String &str,
+    std::u16string &out);
+
+// Appends the UTF-8 encoding of str or name to out. Same result as utf8(),
+// which shares the implementation: the string is read in a single pass, and
+// out's capacity is reused, so pulling many or large strings out of the
+// runtime needn't allocate each time.
+V8JSI_EXPORT void __cdecl appendUtf8(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::String &str,
+    std::string &out);
+V8JSI_EXPORT void __cdecl appendUtf8(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::PropNameID &name,
+    std::string &out);
+
+// Serializes value like JSON.stringify and appends the UTF-8 text to json,
+// so a buffer can be reused across calls. Returns false, leaving json as it
+// was, when there is no JSON text for value (undefined, functions, symbols).
+// Exceptions thrown while serializing, e.g. for cycles, surface as JSError.
+V8JSI_EXPORT bool __cdecl stringifyJsonUtf8(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Value &value,
+    std::string &json);
+
+// Calls func callCount times with this set to jsThis, entering the isolate
+// and the context once for the whole batch. The arguments are laid out flat:
+// call i receives args[i * argsPerCall] .. args[(i + 1) * argsPerCall - 1].
+// When results is not null it must have room for callCount values. A JS
+// exception stops the batch and is rethrown as a JSError.
+V8JSI_EXPORT void __cdecl callBatch(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Function &func,
+    const facebook::jsi::Value &jsThis,
+    const facebook::jsi::Value *args,
+    size_t argsPerCall,
+    size_t callCount,
+    facebook::jsi::Value *results = nullptr);
+
+// Creates an array holding values[0..count) in a single call, instead of
+// createArray followed by a setValueAtIndex per element.
+V8JSI_EXPORT facebook::jsi::Array __cdecl createArrayFromValues(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Value *values,
+    size_t count);
+
+// Fills values with up to count elements of array starting at index start,
+// in a single call instead of a getValueAtIndex per element. The range is
+// clamped to the array's length. values is cleared first, so it can be reused
+// across calls.
+V8JSI_EXPORT void __cdecl getArrayValues(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Array &array,
+    std::vector<facebook::jsi::Value> &values,
+    size_t start = 0,
+    size_t count = SIZE_MAX);
+
+// Reads the properties names[0..count) of object into values[0..count), or
+// sets them from values, within a single scope and TryCatch instead of one
+// getProperty/setProperty call per name. Meant for reading and writing fixed
+// property sets, with names created once up front. An exception thrown by
+// a getter or setter surfaces as a JSError; properties before it have been
+// read or written.
+V8JSI_EXPORT void __cdecl getProperties(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Object &object,
+    const facebook::jsi::PropNameID *names,
+    size_t count,
+    facebook::jsi::Value *values);
+V8JSI_EXPORT void __cdecl setProperties(
+    facebook::jsi::Runtime &runtime,
+    facebook::jsi::Object &object,
+    const facebook::jsi::PropNameID *names,
+    const facebook::jsi::Value *values,
+    size_t count);
+
+// Fills names and values with the own enumerable string keyed properties of
+// object, in property order, in a single call. Unlike getPropertyNames this
+// skips the prototype chain and doesn't need a getProperty per name. Both
+// vectors are cleared first, so they can be reused across calls.
+V8JSI_EXPORT void __cdecl getOwnProperties(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Object &object,
+    std::vector<facebook::jsi::PropNameID> &names,
+    std::vector<facebook::jsi::Value> &values);
+
+// Receives a JSON-like value tree one node at a time, see visitValueTree and
+// buildValueTree. An array is reported as beginArray, its elements and
+// endArray; an object as beginObject, a key followed by its value for each
+// property, and endObject. Strings and keys are UTF-8 and only valid for the
+// duration of the call.
+class ValueTreeVisitor {
+ public:
+  virtual ~ValueTreeVisitor() = default;
+
+  virtual void null() = 0;
+  virtual void boolean(bool value) = 0;
+  virtual void number(double value) = 0;
+  virtual void string(const char *utf8, size_t length) = 0;
+  virtual void beginArray(size_t length) = 0;
+  virtual void endArray() = 0;
+  virtual void beginObject() = 0;
+  virtual void key(const char *utf8, size_t length) = 0;
+  virtual void endObject() = 0;
+};
+
+// Walks value inside the engine and reports it to visitor, with the semantics
+// of jsi::dynamicFromValue: undefined becomes null, object properties are
+// the enumerable string keyed ones (prototypes included), properties holding
+// undefined are skipped, function valued properties become null, and any
+// other function throws a JSError.
+V8JSI_EXPORT void __cdecl visitValueTree(
+    facebook::jsi::Runtime &runtime,
+    const facebook::jsi::Value &value,
+    ValueTreeVisitor &visitor);
+
+// Calls produce with a visitor that builds the reported tree directly as V8
+// values, within a single scope, and returns its root. Property keys are
+// internalized, so repeated keys share one string, but they don't go through
+// the PropNameID cache. produce must report exactly one value.
+V8JSI_EXPORT facebook::jsi::Value __cdecl buildValueTree(
+    facebook::jsi::Runtime &runtime,
+    const std::function<void(ValueTreeVisitor &)> &produce);
+
+// RAII session around enterScope/exitScope, meant to be held across a batch of
+// JSI calls:
+//
+//   v8runtime::EnterScope scope(runtime);
+//   for (auto &name : names)
+//     values.push_back(obj.getProperty(runtime, name));
+class EnterScope {
+ public:
+  explicit EnterScope(facebook::jsi::Runtime &runtime) : runtime_(runtime) {
+    enterScope(runtime_);
+  }
+
+  ~EnterScope() {
+    exitScope(runtime_);
+  }
+
+ private:
+  EnterScope(const EnterScope &) = delete;
+  EnterScope &operator=(const EnterScope &) = delete;
+
+  facebook::jsi::Runtime &runtime_;
+};
 
 } // namespace v8runtime
\ No newline at end of file
@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <folly/json.h>
+#include "jsi/JSIDynamic.h"
+#include "public/V8JsiDynamic.h"
+#include "jsi/test/testlib.h"
+
+using namespace facebook::jsi;
+
+// Checks that the conversions in public/V8JsiDynamic.h agree with the generic
+// ones in jsi/JSIDynamic.cpp, which they replace.
+class V8DynamicTest : public JSITestBase {
+ public:
+  std::string stringify(const Value &value) {
+    Value json = rt.global()
+                     .getPropertyAsObject(rt, "JSON")
+                     .getPropertyAsFunction(rt, "stringify")
+                     .call(rt, value);
+    return json.isString() ? json.getString(rt).utf8(rt) : "undefined";
+  }
+};
+
+TEST_P(V8DynamicTest, ValueFromDynamicTest) {
+  std::vector<folly::dynamic> fixtures = {
+      nullptr,
+      true,
+      2.5,
+      int64_t(42),
+      // Not exactly representable as a double.
+      int64_t(9007199254740993),
+      int64_t(1) << 62,
+      "caf\xc3\xa9",
+      folly::dynamic::array(1, "two", nullptr, folly::dynamic::array(false)),
+      // Number keys become their string form; other keys are dropped.
+      folly::dynamic::object(1, "one")(2.5, "half")("s", int64_t(-7))(
+          true, "dropped"),
+      folly::dynamic::object("nested", folly::dynamic::object("a", "b"))(
+          "list", folly::dynamic::array(folly::dynamic::object()))};
+
+  for (const folly::dynamic &dyn : fixtures) {
+    Value expected = facebook::jsi::valueFromDynamic(rt, dyn);
+    Value actual = v8runtime::valueFromDynamic(rt, dyn);
+    EXPECT_EQ(stringify(actual), stringify(expected)) << folly::toJson(dyn);
+    EXPECT_EQ(
+        facebook::jsi::dynamicFromValue(rt, actual),
+        facebook::jsi::dynamicFromValue(rt, expected))
+        << folly::toJson(dyn);
+  }
+}
+
+TEST_P(V8DynamicTest, DynamicFromValueTest) {
+  const char *fixtures[] = {
+      "undefined",
+      "null",
+      "false",
+      "-0.5",
+      "'caf\xc3\xa9'",
+      // Number keys.
+      "({2: 'two', 1: 'one', b: 'b', a: 'a'})",
+      // Undefined properties are dropped, functions become null.
+      "({u: undefined, f: function() {}, n: null})",
+      // Undefined elements become null.
+      "[1, undefined, 'three', [true, {}]]",
+      "({nested: {list: [{a: undefined}, 9007199254740993]}})"};
+
+  for (const char *code : fixtures) {
+    Value value = eval((std::string("(") + code + ")").c_str());
+    EXPECT_EQ(
+        v8runtime::dynamicFromValue(rt, value),
+        facebook::jsi::dynamicFromValue(rt, value))
+        << code;
+  }
+
+  // Both refuse a function that isn't an object property.
+  Value fn = eval("(function() {})");
+  EXPECT_THROW(v8runtime::dynamicFromValue(rt, fn), JSError);
+  EXPECT_THROW(facebook::jsi::dynamicFromValue(rt, fn), JSError);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    Runtimes,
+    V8DynamicTest,
+    ::testing::ValuesIn(runtimeGenerators()));
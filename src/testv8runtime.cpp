@@ -0,0 +1,1445 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include "v8-fast-api-calls.h"
+#include "public/ScriptStore.h"
+#include "public/V8JsiCoroutine.h"
+#include "public/V8JsiRuntime.h"
+#include "jsi/test/testlib.h"
+
+using namespace facebook::jsi;
+
+// Tests for the V8 specific entry points declared in public/V8JsiRuntime.h.
+class V8RuntimeTest : public JSITestBase {};
+
+namespace {
+
+// Runs fn iterations times and prints how long it took, for the DISABLED_
+// benchmarks. Returns the elapsed time in seconds.
+double Measure(
+    const std::string &name,
+    int iterations,
+    const std::function<void()> &fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+    fn();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << name << ": " << elapsed.count() * 1000 << " ms, "
+            << iterations / elapsed.count() << " runs/sec" << std::endl;
+  return elapsed.count();
+}
+
+} // namespace
+
+TEST_P(V8RuntimeTest, EnterScopeTest) {
+  eval("x = {a: 1, b: 'two', c: {d: 3}}");
+  Object x = rt.global().getPropertyAsObject(rt, "x");
+
+  {
+    v8runtime::EnterScope scope(rt);
+    EXPECT_EQ(x.getProperty(rt, "a").getNumber(), 1);
+    EXPECT_EQ(x.getProperty(rt, "b").getString(rt).utf8(rt), "two");
+
+    {
+      // Sessions nest.
+      v8runtime::EnterScope inner(rt);
+      EXPECT_EQ(
+          x.getPropertyAsObject(rt, "c").getProperty(rt, "d").getNumber(), 3);
+    }
+
+    x.setProperty(rt, "e", 5);
+    EXPECT_THROW(eval("throw new Error('boom')"), JSError);
+    EXPECT_EQ(eval("x.e").getNumber(), 5);
+  }
+
+  EXPECT_EQ(x.getProperty(rt, "e").getNumber(), 5);
+}
+
+TEST_P(V8RuntimeTest, MicrotasksTest) {
+  const char *schedule =
+      "var runs = (typeof runs === 'undefined') ? 0 : runs;"
+      "Promise.resolve().then(() => { runs++; })"
+      "    .then(() => queueMicrotask(() => { runs++; }));";
+
+  // By default the microtasks run as soon as the outermost call returns.
+  eval(schedule);
+  EXPECT_EQ(eval("runs").getNumber(), 2);
+  EXPECT_TRUE(v8runtime::drainMicrotasks(rt));
+
+  v8runtime::V8RuntimeArgs args;
+  args.microtasksPolicy = v8runtime::MicrotasksPolicy::Explicit;
+  auto runtime = v8runtime::makeV8Runtime(std::move(args));
+  auto evaluate = [&runtime](const char *code) {
+    return runtime->evaluateJavaScript(
+        std::make_unique<StringBuffer>(code), "");
+  };
+
+  // With the explicit policy, only drainMicrotasks runs them.
+  evaluate(schedule);
+  evaluate(schedule);
+  EXPECT_EQ(evaluate("runs").getNumber(), 0);
+  EXPECT_TRUE(v8runtime::drainMicrotasks(*runtime));
+  EXPECT_EQ(evaluate("runs").getNumber(), 4);
+  EXPECT_TRUE(v8runtime::drainMicrotasks(*runtime));
+
+  // The runtimes' queues are separate.
+  evaluate(schedule);
+  EXPECT_TRUE(v8runtime::drainMicrotasks(rt));
+  EXPECT_EQ(evaluate("runs").getNumber(), 4);
+  EXPECT_TRUE(v8runtime::drainMicrotasks(*runtime));
+  EXPECT_EQ(evaluate("runs").getNumber(), 6);
+}
+
+TEST_P(V8RuntimeTest, PromiseResolverTest) {
+  Object resolver = v8runtime::createPromiseResolver(rt);
+  rt.global().setProperty(rt, "p", v8runtime::getPromise(rt, resolver));
+  eval("var result = 'pending'; p.then(v => { result = v; })");
+  v8runtime::drainMicrotasks(rt);
+  EXPECT_EQ(eval("result").getString(rt).utf8(rt), "pending");
+
+  v8runtime::resolvePromise(rt, resolver, Value(42));
+  v8runtime::drainMicrotasks(rt);
+  EXPECT_EQ(eval("result").getNumber(), 42);
+
+  // Only the first settlement counts.
+  v8runtime::rejectPromise(rt, resolver, Value(1));
+  v8runtime::drainMicrotasks(rt);
+  EXPECT_EQ(eval("result").getNumber(), 42);
+
+  Object failing = v8runtime::createPromiseResolver(rt);
+  rt.global().setProperty(rt, "f", v8runtime::getPromise(rt, failing));
+  eval("var reason; f.catch(e => { reason = e.message; })");
+  v8runtime::rejectPromise(rt, failing, eval("new Error('failed')"));
+  v8runtime::drainMicrotasks(rt);
+  EXPECT_EQ(eval("reason").getString(rt).utf8(rt), "failed");
+
+  EXPECT_THROW(v8runtime::getPromise(rt, Object(rt)), JSINativeException);
+  EXPECT_THROW(
+      v8runtime::resolvePromise(rt, Object(rt), Value()), JSINativeException);
+}
+
+#ifdef V8JSI_HAS_COROUTINES
+namespace {
+
+// Suspends until the test resumes it, standing in for asynchronous I/O.
+struct ManualEvent {
+  std::vector<std::coroutine_handle<>> waiters;
+
+  auto wait() {
+    struct Awaiter {
+      ManualEvent &event;
+      bool await_ready() const noexcept {
+        return false;
+      }
+      void await_suspend(std::coroutine_handle<> handle) {
+        event.waiters.push_back(handle);
+      }
+      void await_resume() const noexcept {}
+    };
+    return Awaiter{*this};
+  }
+
+  void set() {
+    std::vector<std::coroutine_handle<>> resumed = std::move(waiters);
+    for (std::coroutine_handle<> handle : resumed)
+      handle.resume();
+  }
+};
+
+} // namespace
+
+TEST_P(V8RuntimeTest, AsyncHostFunctionTest) {
+  ManualEvent event;
+  Function twice = v8runtime::createAsyncHostFunction(
+      rt,
+      PropNameID::forAscii(rt, "twice"),
+      1,
+      [&event](Runtime &rt, Value, std::vector<Value> args)
+          -> v8runtime::AsyncValue {
+        co_await event.wait();
+        if (!args.at(0).isNumber())
+          throw std::invalid_argument("twice takes a number");
+        co_return args[0].getNumber() * 2;
+      });
+  rt.global().setProperty(rt, "twice", twice);
+
+  eval("var results = [];"
+       "twice(21).then(v => results.push(v));"
+       "twice('x').catch(e => results.push(e.message));");
+  v8runtime::drainMicrotasks(rt);
+  EXPECT_EQ(eval("results.length").getNumber(), 0);
+
+  event.set();
+  v8runtime::drainMicrotasks(rt);
+  EXPECT_EQ(
+      eval("results.join()").getString(rt).utf8(rt),
+      "42,twice takes a number");
+}
+#endif // V8JSI_HAS_COROUTINES
+
+TEST_P(V8RuntimeTest, NestedRuntimeContextTest) {
+  // Runtimes on one thread share the isolate. A call into rt made from the
+  // other runtime's callback must still run in rt's context, even while rt
+  // is entered further up the stack.
+  auto other = factory();
+  Function callback = Function::createFromHostFunction(
+      *other,
+      PropNameID::forAscii(*other, "callback"),
+      0,
+      [this](Runtime &, const Value &, const Value *, size_t) {
+        rt.global().setProperty(rt, "created", Object(rt));
+        return Value();
+      });
+
+  {
+    v8runtime::EnterScope scope(rt);
+    callback.call(*other);
+  }
+
+  EXPECT_TRUE(
+      eval("Object.getPrototypeOf(created) === Object.prototype").getBool());
+}
+
+TEST_P(V8RuntimeTest, PropNameIDCacheTest) {
+  v8runtime::V8RuntimeStats before = v8runtime::getRuntimeStats(rt);
+
+  PropNameID width = PropNameID::forAscii(rt, "width");
+  PropNameID width2 = PropNameID::forUtf8(rt, std::string("width"));
+  PropNameID height = PropNameID::forAscii(rt, "height");
+
+  v8runtime::V8RuntimeStats after = v8runtime::getRuntimeStats(rt);
+  EXPECT_EQ(after.propNameIDCacheHits - before.propNameIDCacheHits, 1u);
+  EXPECT_EQ(after.propNameIDCacheMisses - before.propNameIDCacheMisses, 2u);
+
+  EXPECT_TRUE(PropNameID::compare(rt, width, width2));
+  EXPECT_FALSE(PropNameID::compare(rt, width, height));
+  EXPECT_TRUE(PropNameID::compare(
+      rt, width, PropNameID::forString(rt, String::createFromAscii(rt, "width"))));
+  EXPECT_EQ(width2.utf8(rt), "width");
+
+  Object obj(rt);
+  obj.setProperty(rt, width, 10);
+  EXPECT_EQ(obj.getProperty(rt, width2).getNumber(), 10);
+}
+
+TEST_P(V8RuntimeTest, PropNameIDCacheEvictionTest) {
+  for (int i = 0; i < 20000; i++) {
+    PropNameID::forUtf8(rt, "name" + std::to_string(i));
+  }
+  v8runtime::V8RuntimeStats flooded = v8runtime::getRuntimeStats(rt);
+  EXPECT_LE(flooded.propNameIDCacheSize, 4096u);
+
+  // Names used after the cache filled up still get cached.
+  PropNameID::forAscii(rt, "hotName");
+  v8runtime::V8RuntimeStats before = v8runtime::getRuntimeStats(rt);
+  PropNameID hot = PropNameID::forAscii(rt, "hotName");
+  v8runtime::V8RuntimeStats after = v8runtime::getRuntimeStats(rt);
+  EXPECT_EQ(after.propNameIDCacheHits - before.propNameIDCacheHits, 1u);
+  EXPECT_EQ(hot.utf8(rt), "hotName");
+}
+
+TEST_P(V8RuntimeTest, PropNameIDCacheHighBytesTest) {
+  // forAscii reads bytes past 7 bits as Latin-1, forUtf8 decodes them. The
+  // cache must not hand the string made by one to the other, in either order.
+  const std::string bytes = "\xc3\xa9";
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ(
+        PropNameID::forAscii(rt, bytes.data(), bytes.size()).utf8(rt),
+        "\xc3\x83\xc2\xa9");
+    EXPECT_EQ(PropNameID::forUtf8(rt, bytes).utf8(rt), "\xc3\xa9");
+  }
+  EXPECT_EQ(
+      PropNameID::forAscii(rt, bytes.data(), bytes.size()).utf8(rt),
+      "\xc3\x83\xc2\xa9");
+}
+
+TEST_P(V8RuntimeTest, HostObjectPropNameTest) {
+  class NameRecorder : public HostObject {
+   public:
+    Value get(Runtime &rt, const PropNameID &name) override {
+      names.push_back(name.utf8(rt));
+      return String::createFromUtf8(rt, names.back());
+    }
+
+    void set(Runtime &rt, const PropNameID &name, const Value & /*value*/)
+        override {
+      names.push_back(name.utf8(rt));
+    }
+
+    std::vector<std::string> names;
+  };
+
+  auto recorder = std::make_shared<NameRecorder>();
+  rt.global().setProperty(
+      rt, "ho", Object::createFromHostObject(rt, recorder));
+
+  EXPECT_EQ(eval("ho.caf\\u00e9").getString(rt).utf8(rt), "caf\xc3\xa9");
+  eval("ho.size = 1");
+  EXPECT_EQ(eval("ho[7]").getString(rt).utf8(rt), "7");
+
+  // Symbol keyed lookups are not forwarded to the HostObject.
+  EXPECT_TRUE(eval("ho[Symbol.iterator] === undefined").getBool());
+  EXPECT_EQ(recorder->names.size(), 3u);
+  EXPECT_EQ(recorder->names[1], "size");
+}
+
+TEST_P(V8RuntimeTest, IndexedHostObjectTest) {
+  class NumberList : public v8runtime::IndexedHostObject {
+   public:
+    Value get(Runtime &rt, const PropNameID &name) override {
+      if (name.utf8(rt) == "length")
+        return static_cast<int>(items.size());
+      namedGets++;
+      return Value();
+    }
+
+    Value getIndex(Runtime &, uint32_t index) override {
+      return items[index];
+    }
+
+    void setIndex(Runtime &, uint32_t index, const Value &value) override {
+      if (index >= items.size())
+        throw std::out_of_range("index out of range");
+      items[index] = value.getNumber();
+    }
+
+    uint32_t length(Runtime &) override {
+      return static_cast<uint32_t>(items.size());
+    }
+
+    std::vector<double> items{1, 2, 3};
+    int namedGets = 0;
+  };
+
+  auto buffer = std::make_shared<NumberList>();
+  Object obj = v8runtime::createIndexedHostObject(rt, buffer);
+  rt.global().setProperty(rt, "buf", obj);
+
+  EXPECT_TRUE(obj.isHostObject(rt));
+  EXPECT_EQ(obj.getHostObject(rt), buffer);
+
+  EXPECT_EQ(
+      eval("var s = 0; for (var i = 0; i < buf.length; i++) s += buf[i]; s")
+          .getNumber(),
+      6);
+  eval("buf[1] = 20");
+  EXPECT_EQ(buffer->items[1], 20);
+  EXPECT_TRUE(eval("buf[3] === undefined").getBool());
+  EXPECT_THROW(eval("buf[5] = 1"), JSError);
+  EXPECT_EQ(eval("Object.keys(buf).join()").getString(rt).utf8(rt), "0,1,2");
+  EXPECT_EQ(buffer->namedGets, 0);
+}
+
+namespace {
+
+class Point : public HostObject {
+ public:
+  Value get(Runtime &, const PropNameID &) override {
+    interceptedGets++;
+    return Value();
+  }
+
+  double x = 3;
+  double y = 4;
+  int interceptedGets = 0;
+};
+
+v8runtime::HostObjectClassDescription describePoint() {
+  v8runtime::HostObjectClassDescription description;
+  description.className = "Point";
+  description.properties.push_back(
+      {"x",
+       [](Runtime &, HostObject &ho) {
+         return Value(static_cast<Point &>(ho).x);
+       },
+       [](Runtime &, HostObject &ho, const Value &value) {
+         static_cast<Point &>(ho).x = value.getNumber();
+       }});
+  description.properties.push_back(
+      {"y",
+       [](Runtime &, HostObject &ho) {
+         return Value(static_cast<Point &>(ho).y);
+       },
+       nullptr});
+  description.properties.push_back(
+      {"fails",
+       [](Runtime &, HostObject &) -> Value {
+         throw std::runtime_error("getter failed");
+       },
+       nullptr});
+  description.methods.push_back(
+      {"scaledLength",
+       1,
+       [](Runtime &, HostObject &ho, const Value *args, size_t count) {
+         Point &point = static_cast<Point &>(ho);
+         double scale = count > 0 ? args[0].getNumber() : 1;
+         return Value(scale * std::sqrt(point.x * point.x + point.y * point.y));
+       }});
+  return description;
+}
+
+} // namespace
+
+TEST_P(V8RuntimeTest, HostObjectClassTest) {
+  v8runtime::HostObjectClass *pointClass =
+      v8runtime::createHostObjectClass(rt, describePoint());
+  auto point = std::make_shared<Point>();
+  Object obj = v8runtime::createHostObject(rt, pointClass, point);
+  rt.global().setProperty(rt, "p", obj);
+
+  EXPECT_TRUE(obj.isHostObject(rt));
+  EXPECT_EQ(obj.getHostObject(rt), point);
+
+  EXPECT_EQ(eval("p.x + p.y").getNumber(), 7);
+  EXPECT_EQ(eval("p.scaledLength(2)").getNumber(), 10);
+  eval("p.x = 6; p.y = 100");
+  EXPECT_EQ(point->x, 6);
+  EXPECT_EQ(point->y, 4);
+  EXPECT_THROW(eval("'use strict'; p.y = 1"), JSError);
+
+  // Other names are plain JS properties and never reach the HostObject.
+  EXPECT_TRUE(eval("p.z === undefined && typeof p.toString").isString());
+  eval("p.z = 1");
+  EXPECT_EQ(eval("p.z").getNumber(), 1);
+  EXPECT_EQ(point->interceptedGets, 0);
+
+  EXPECT_EQ(
+      eval("p.constructor.name").getString(rt).utf8(rt), "Point");
+  EXPECT_EQ(
+      eval("Object.keys(Object.getPrototypeOf(p)).join()")
+          .getString(rt)
+          .utf8(rt),
+      "x,y,fails");
+  EXPECT_THROW(eval("p.fails"), JSError);
+
+  // Instances share the class's prototype; other receivers are rejected.
+  Object other = v8runtime::createHostObject(
+      rt, pointClass, std::make_shared<Point>());
+  rt.global().setProperty(rt, "q", other);
+  EXPECT_TRUE(
+      eval("Object.getPrototypeOf(p) === Object.getPrototypeOf(q)").getBool());
+  EXPECT_EQ(eval("q.x").getNumber(), 3);
+  EXPECT_THROW(eval("p.scaledLength.call({}, 1)"), JSError);
+  EXPECT_THROW(
+      eval("Object.getOwnPropertyDescriptor("
+           "Object.getPrototypeOf(p), 'x').get.call({})"),
+      JSError);
+  EXPECT_THROW(eval("new p.scaledLength()"), JSError);
+}
+
+// Run with --gtest_also_run_disabled_tests.
+TEST_P(V8RuntimeTest, DISABLED_HostObjectClassBenchmark) {
+  class InterceptedPoint : public HostObject {
+   public:
+    Value get(Runtime &rt, const PropNameID &name) override {
+      return name.utf8(rt) == "x" ? Value(x) : Value();
+    }
+
+    double x = 1;
+  };
+
+  v8runtime::HostObjectClass *pointClass =
+      v8runtime::createHostObjectClass(rt, describePoint());
+  rt.global().setProperty(
+      rt,
+      "intercepted",
+      Object::createFromHostObject(rt, std::make_shared<InterceptedPoint>()));
+  rt.global().setProperty(
+      rt,
+      "schema",
+      v8runtime::createHostObject(rt, pointClass, std::make_shared<Point>()));
+  Function read = function(
+      "function (o) { var s = 0; for (var i = 0; i < 1000000; i++) s += o.x; "
+      "return s; }");
+
+  for (const char *name : {"intercepted", "schema"}) {
+    Value obj = rt.global().getProperty(rt, name);
+    Measure(name, 1, [&] { read.call(rt, obj); });
+  }
+}
+
+TEST_P(V8RuntimeTest, HostObjectTrackingTest) {
+  size_t before = v8runtime::getRuntimeStats(rt).liveHostObjectTrackers;
+
+  Object ho = Object::createFromHostObject(rt, std::make_shared<HostObject>());
+  Function hf = Function::createFromHostFunction(
+      rt,
+      PropNameID::forAscii(rt, "hf"),
+      0,
+      [](Runtime &, const Value &, const Value *, size_t) { return Value(); });
+
+  EXPECT_EQ(
+      v8runtime::getRuntimeStats(rt).liveHostObjectTrackers, before + 2);
+
+  EXPECT_TRUE(ho.isHostObject(rt));
+  EXPECT_FALSE(Object(rt).isHostObject(rt));
+  EXPECT_FALSE(hf.isHostObject(rt));
+  EXPECT_FALSE(eval("new Date()").getObject(rt).isHostObject(rt));
+}
+
+TEST_P(V8RuntimeTest, HostObjectTrackerCollectedTest) {
+  class Counted : public HostObject {
+   public:
+    explicit Counted(int &destroyed) : destroyed_(destroyed) {}
+    ~Counted() override {
+      destroyed_++;
+    }
+
+   private:
+    int &destroyed_;
+  };
+
+  v8runtime::V8RuntimeArgs args;
+  args.exposeGC = true;
+  auto runtime = v8runtime::makeV8Runtime(std::move(args));
+  size_t before = v8runtime::getRuntimeStats(*runtime).liveHostObjectTrackers;
+
+  int destroyed = 0;
+  {
+    Object ho = Object::createFromHostObject(
+        *runtime, std::make_shared<Counted>(destroyed));
+    auto captured = std::make_shared<Counted>(destroyed);
+    Function hf = Function::createFromHostFunction(
+        *runtime,
+        PropNameID::forAscii(*runtime, "hf"),
+        0,
+        [captured](Runtime &, const Value &, const Value *, size_t) {
+          return Value();
+        });
+    captured.reset();
+
+    hf.call(*runtime, ho);
+    EXPECT_EQ(
+        v8runtime::getRuntimeStats(*runtime).liveHostObjectTrackers,
+        before + 2);
+  }
+  EXPECT_EQ(destroyed, 0);
+
+  // Once collected, the weak callbacks release the HostObject and the
+  // function, and remove their trackers.
+  runtime->global().getPropertyAsFunction(*runtime, "gc").call(*runtime);
+  EXPECT_EQ(
+      v8runtime::getRuntimeStats(*runtime).liveHostObjectTrackers, before);
+  EXPECT_EQ(destroyed, 2);
+}
+
+TEST_P(V8RuntimeTest, HostFunctionArgsTest) {
+  std::vector<Value> kept;
+  Function hf = Function::createFromHostFunction(
+      rt,
+      PropNameID::forAscii(rt, "hf"),
+      0,
+      [&kept](
+          Runtime &rt, const Value &thisVal, const Value *args, size_t count) {
+        double sum = 0;
+        for (size_t i = 0; i < count; i++) {
+          if (args[i].isNumber())
+            sum += args[i].getNumber();
+          else
+            kept.emplace_back(rt, args[i]);
+        }
+        kept.emplace_back(rt, thisVal);
+        return Value(sum);
+      });
+  rt.global().setProperty(rt, "hf", hf);
+
+  EXPECT_EQ(eval("hf(1, 2, 3)").getNumber(), 6);
+  EXPECT_EQ(eval("hf(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12)").getNumber(), 78);
+  EXPECT_EQ(eval("hf.call({x: 1}, 'a', {y: 2})").getNumber(), 0);
+
+  // Copies of borrowed arguments stay valid after the call returns.
+  ASSERT_EQ(kept.size(), 5u);
+  EXPECT_EQ(kept[2].getString(rt).utf8(rt), "a");
+  EXPECT_EQ(kept[3].getObject(rt).getProperty(rt, "y").getNumber(), 2);
+  EXPECT_EQ(kept[4].getObject(rt).getProperty(rt, "x").getNumber(), 1);
+}
+
+TEST_P(V8RuntimeTest, TemplateHostFunctionTest) {
+  // Without a fast function, or from unoptimized code, calls go to func.
+  Function hypot = v8runtime::createFunctionFromHostFunction(
+      rt,
+      PropNameID::forAscii(rt, "hypot"),
+      2,
+      [](Runtime &rt, const Value &, const Value *args, size_t count) {
+        if (count < 2)
+          throw JSError(rt, "hypot takes two numbers");
+        double a = args[0].getNumber();
+        double b = args[1].getNumber();
+        return Value(std::sqrt(a * a + b * b));
+      },
+      nullptr);
+  rt.global().setProperty(rt, "hypot", hypot);
+
+  EXPECT_EQ(eval("hypot(3, 4)").getNumber(), 5);
+  EXPECT_EQ(eval("hypot.name").getString(rt).utf8(rt), "hypot");
+  EXPECT_EQ(eval("hypot.length").getNumber(), 2);
+  EXPECT_EQ(
+      eval("var s = 0; for (var i = 0; i < 10000; i++) s += hypot(i, 0); s")
+          .getNumber(),
+      49995000);
+  EXPECT_THROW(eval("hypot(1)"), JSError);
+  EXPECT_THROW(eval("new hypot(3, 4)"), JSError);
+}
+
+namespace {
+
+// Fast API callbacks get no data, hence the globals.
+int32_t fastSum = 0;
+int fastCalls = 0;
+
+void FastAccumulate(v8::ApiObject /*receiver*/, int32_t value) {
+  fastSum += value;
+  fastCalls++;
+}
+
+} // namespace
+
+TEST_P(V8RuntimeTest, FastHostFunctionTest) {
+  v8runtime::V8RuntimeArgs args;
+  args.enableFastApiCalls = true;
+  args.allowNativesSyntax = true;
+  auto runtime = v8runtime::makeV8Runtime(std::move(args));
+
+  fastSum = 0;
+  fastCalls = 0;
+  int slowCalls = 0;
+  v8::CFunction fastFunction = v8::CFunction::Make(FastAccumulate);
+  Function accumulate = v8runtime::createFunctionFromHostFunction(
+      *runtime,
+      PropNameID::forAscii(*runtime, "accumulate"),
+      1,
+      [&slowCalls](Runtime &, const Value &, const Value *args, size_t count) {
+        slowCalls++;
+        if (count > 0)
+          fastSum += static_cast<int32_t>(args[0].getNumber());
+        return Value();
+      },
+      &fastFunction);
+  runtime->global().setProperty(*runtime, "accumulate", accumulate);
+
+  // Has TurboFan optimize run, synchronously, once it has seen a few calls;
+  // the optimized code then calls FastAccumulate directly.
+  runtime->evaluateJavaScript(
+      std::make_unique<StringBuffer>(
+          "function run(n) { for (var i = 0; i < n; i++) accumulate(i & 3); }"
+          "%PrepareFunctionForOptimization(run);"
+          "run(4);"
+          "run(4);"
+          "%OptimizeFunctionOnNextCall(run);"
+          "run(10000);"),
+      "");
+  EXPECT_EQ(fastSum, 15012);
+  EXPECT_EQ(fastCalls + slowCalls, 10008);
+  EXPECT_GT(fastCalls, 0);
+}
+
+TEST_P(V8RuntimeTest, ArrayBufferTest) {
+  Object obj =
+      eval("buf = new ArrayBuffer(16); new Uint8Array(buf)[3] = 42; buf")
+          .getObject(rt);
+  ASSERT_TRUE(obj.isArrayBuffer(rt));
+  EXPECT_FALSE(eval("[]").getObject(rt).isArrayBuffer(rt));
+
+  ArrayBuffer buf = obj.getArrayBuffer(rt);
+  EXPECT_EQ(buf.size(rt), 16u);
+  EXPECT_EQ(buf.data(rt)[3], 42);
+  buf.data(rt)[5] = 7;
+  EXPECT_EQ(eval("new Uint8Array(buf)[5]").getNumber(), 7);
+}
+
+TEST_P(V8RuntimeTest, WeakObjectCollectedTest) {
+  v8runtime::V8RuntimeArgs args;
+  args.exposeGC = true;
+  auto runtime = v8runtime::makeV8Runtime(std::move(args));
+
+  Object obj(*runtime);
+  obj.setProperty(*runtime, "a", 1);
+  WeakObject weak(*runtime, obj);
+  EXPECT_TRUE(weak.lock(*runtime).isObject());
+
+  // Once the last strong reference is gone, a full GC collects the object.
+  obj = Object(*runtime);
+  runtime->global().getPropertyAsFunction(*runtime, "gc").call(*runtime);
+  EXPECT_TRUE(weak.lock(*runtime).isUndefined());
+}
+
+TEST_P(V8RuntimeTest, ExternalArrayBufferTest) {
+  std::vector<uint8_t> memory{1, 2, 3, 4};
+  int deleted = 0;
+  {
+    auto runtime = factory();
+    ArrayBuffer buf = v8runtime::createExternalArrayBuffer(
+        *runtime, memory.data(), memory.size(), [&](uint8_t *data) {
+          EXPECT_EQ(data, memory.data());
+          deleted++;
+        });
+    EXPECT_EQ(buf.data(*runtime), memory.data());
+    EXPECT_EQ(buf.size(*runtime), memory.size());
+
+    runtime->global().setProperty(*runtime, "buf", buf);
+    runtime->evaluateJavaScript(
+        std::make_unique<StringBuffer>("new Uint8Array(buf)[0] = 9;"), "");
+    EXPECT_EQ(memory[0], 9);
+
+    // Read only buffers are copied, so JS writes can't reach them.
+    auto shared = std::make_shared<StringBuffer>("abc");
+    ArrayBuffer text = v8runtime::createArrayBuffer(*runtime, shared);
+    EXPECT_NE(text.data(*runtime), shared->data());
+    ASSERT_EQ(text.size(*runtime), 3u);
+    EXPECT_EQ(std::memcmp(text.data(*runtime), "abc", 3), 0);
+    text.data(*runtime)[0] = 'x';
+    EXPECT_EQ(shared->data()[0], 'a');
+    EXPECT_EQ(deleted, 0);
+  }
+
+  // Tearing down the runtime releases every backing store.
+  EXPECT_EQ(deleted, 1);
+}
+
+TEST_P(V8RuntimeTest, TypedArrayTest) {
+  std::vector<float> samples{0.5f, 1.5f, 2.5f, 3.5f};
+  Object copied = v8runtime::createTypedArray(
+      rt, v8runtime::TypedArrayKind::Float32Array, samples.data(), 4);
+  EXPECT_TRUE(function("function (a) { return a instanceof Float32Array && "
+                       "a.length === 4 && a[3] === 3.5; }")
+                  .call(rt, copied)
+                  .getBool());
+
+  v8runtime::TypedArrayData data;
+  ASSERT_TRUE(v8runtime::getTypedArrayData(rt, copied, data));
+  EXPECT_EQ(data.kind, v8runtime::TypedArrayKind::Float32Array);
+  EXPECT_EQ(data.length, 4u);
+  EXPECT_EQ(data.byteLength, 16u);
+  EXPECT_NE(data.data, reinterpret_cast<uint8_t *>(samples.data()));
+  EXPECT_EQ(std::memcmp(data.data, samples.data(), 16), 0);
+
+  Object zeroed = v8runtime::createTypedArray(
+      rt, v8runtime::TypedArrayKind::Float64Array, nullptr, 2);
+  ASSERT_TRUE(v8runtime::getTypedArrayData(rt, zeroed, data));
+  EXPECT_EQ(data.byteLength, 16u);
+  EXPECT_EQ(reinterpret_cast<double *>(data.data)[1], 0.0);
+
+  // A view over host memory, offset into the buffer.
+  ArrayBuffer buffer = v8runtime::createExternalArrayBuffer(
+      rt,
+      reinterpret_cast<uint8_t *>(samples.data()),
+      samples.size() * sizeof(float),
+      nullptr);
+  Object view = v8runtime::createTypedArray(
+      rt, v8runtime::TypedArrayKind::Float32Array, buffer, 4, 2);
+  ASSERT_TRUE(v8runtime::getTypedArrayData(rt, view, data));
+  EXPECT_EQ(data.data, reinterpret_cast<uint8_t *>(samples.data() + 1));
+  EXPECT_EQ(data.length, 2u);
+  function("function (a) { a[0] = 10; }").call(rt, view);
+  EXPECT_EQ(samples[1], 10.0f);
+
+  EXPECT_THROW(
+      v8runtime::createTypedArray(
+          rt, v8runtime::TypedArrayKind::Float32Array, buffer, 2, 1),
+      JSINativeException);
+  EXPECT_THROW(
+      v8runtime::createTypedArray(
+          rt, v8runtime::TypedArrayKind::Float64Array, buffer, 8, 2),
+      JSINativeException);
+
+  // Lengths past V8's limit, or whose byte length overflows.
+  EXPECT_THROW(
+      v8runtime::createTypedArray(
+          rt, v8runtime::TypedArrayKind::Uint8Array, nullptr, SIZE_MAX),
+      JSINativeException);
+  EXPECT_THROW(
+      v8runtime::createTypedArray(
+          rt, v8runtime::TypedArrayKind::Float64Array, nullptr, SIZE_MAX / 4),
+      JSINativeException);
+
+  // Typed arrays created by JS, including small ones kept on the V8 heap.
+  Object small = eval("new Uint8Array([1, 2, 3])").getObject(rt);
+  ASSERT_TRUE(v8runtime::getTypedArrayData(rt, small, data));
+  EXPECT_EQ(data.kind, v8runtime::TypedArrayKind::Uint8Array);
+  ASSERT_EQ(data.length, 3u);
+  EXPECT_EQ(data.data[2], 3);
+
+  Object sub = eval("new Int16Array([1, 2, 3, 4]).subarray(1)").getObject(rt);
+  ASSERT_TRUE(v8runtime::getTypedArrayData(rt, sub, data));
+  EXPECT_EQ(data.kind, v8runtime::TypedArrayKind::Int16Array);
+  EXPECT_EQ(data.length, 3u);
+  EXPECT_EQ(reinterpret_cast<int16_t *>(data.data)[0], 2);
+
+  EXPECT_FALSE(
+      v8runtime::getTypedArrayData(rt, eval("[1, 2]").getObject(rt), data));
+  EXPECT_FALSE(v8runtime::getTypedArrayData(
+      rt, eval("new DataView(new ArrayBuffer(4))").getObject(rt), data));
+}
+
+TEST_P(V8RuntimeTest, ScopeTest) {
+  Object obj = eval("({a: {b: 1}, s: 'str'})").getObject(rt);
+
+  // Values created and dropped inside scopes, repeatedly.
+  double sum = 0;
+  for (int i = 0; i < 1000; i++) {
+    Scope scope(rt);
+    Object a = obj.getPropertyAsObject(rt, "a");
+    sum += a.getProperty(rt, "b").getNumber();
+    Object temp(rt);
+    temp.setProperty(rt, "x", a);
+    Object x = temp.getPropertyAsObject(rt, "x");
+    sum += x.getProperty(rt, "b").getNumber();
+  }
+  EXPECT_EQ(sum, 2000);
+
+  // Values escaping nested scopes stay usable.
+  Value outer;
+  String escaped = String::createFromAscii(rt, "before");
+  {
+    Scope scope1(rt);
+    Object o1(rt);
+    o1.setProperty(rt, "n", 1);
+    {
+      Scope scope2(rt);
+      Object o2(rt);
+      o2.setProperty(rt, "n", 2);
+      o1.setProperty(rt, "inner", o2);
+      outer = Value(rt, o2);
+      escaped = obj.getProperty(rt, "s").getString(rt);
+    }
+    EXPECT_EQ(outer.getObject(rt).getProperty(rt, "n").getNumber(), 2);
+    outer = std::move(o1);
+  }
+  EXPECT_EQ(outer.getObject(rt).getProperty(rt, "n").getNumber(), 1);
+  EXPECT_EQ(
+      outer.getObject(rt)
+          .getPropertyAsObject(rt, "inner")
+          .getProperty(rt, "n")
+          .getNumber(),
+      2);
+  EXPECT_EQ(escaped.utf8(rt), "str");
+
+  // Host functions called from inside a scope can keep what they create.
+  std::vector<Value> kept;
+  Function keep = Function::createFromHostFunction(
+      rt,
+      PropNameID::forAscii(rt, "keep"),
+      1,
+      [&kept](Runtime &rt, const Value &, const Value *args, size_t) {
+        kept.emplace_back(rt, args[0]);
+        kept.push_back(Object(rt));
+        return Value();
+      });
+  {
+    Scope scope(rt);
+    keep.call(rt, Object(rt));
+    Scope::callInNewScope(
+        rt, [&] { keep.call(rt, String::createFromAscii(rt, "k")); });
+  }
+  ASSERT_EQ(kept.size(), 4u);
+  EXPECT_TRUE(kept[0].isObject());
+  EXPECT_EQ(kept[2].getString(rt).utf8(rt), "k");
+  EXPECT_TRUE(kept[3].getObject(rt).getPropertyNames(rt).size(rt) == 0);
+}
+
+TEST_P(V8RuntimeTest, CallBatchTest) {
+  Function add = function("function(a, b) { return this.base + a + b; }");
+  Object self = eval("({base: 100})").getObject(rt);
+
+  Value args[] = {1, 2, 3, 4, 5, 6};
+  Value results[3];
+  v8runtime::callBatch(rt, add, Value(rt, self), args, 2, 3, results);
+  EXPECT_EQ(results[0].getNumber(), 103);
+  EXPECT_EQ(results[1].getNumber(), 107);
+  EXPECT_EQ(results[2].getNumber(), 111);
+
+  eval("calls = []");
+  Function record = function("function(x) { calls.push(x); }");
+  v8runtime::callBatch(rt, record, Value(), args, 1, 6);
+  EXPECT_EQ(eval("calls.join()").getString(rt).utf8(rt), "1,2,3,4,5,6");
+
+  Function thrower =
+      function("function(x) { if (x == 2) throw new Error('two'); }");
+  EXPECT_THROW(
+      v8runtime::callBatch(rt, thrower, Value(), args, 1, 6), JSError);
+
+  // Arities past the inline argument buffer.
+  Function sum = function(
+      "function() { var s = 0; for (var a of arguments) s += a; return s; }");
+  Value many[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  const Value *manyArgs = many;
+  const size_t manyCount = sizeof(many) / sizeof(many[0]);
+  EXPECT_EQ(sum.call(rt, manyArgs, manyCount).getNumber(), 55);
+  Function ctor = function("function() { this.count = arguments.length; }");
+  EXPECT_EQ(
+      ctor.callAsConstructor(rt, manyArgs, manyCount)
+          .getObject(rt)
+          .getProperty(rt, "count")
+          .getNumber(),
+      10);
+}
+
+TEST_P(V8RuntimeTest, CreateValueFromJsonUtf8Test) {
+  std::string json =
+      "{\"a\": [1, 2, {\"b\": \"\\u00e9t\xc3\xa9\"}], \"c\": null}";
+  Value value = Value::createFromJsonUtf8(
+      rt, reinterpret_cast<const uint8_t *>(json.data()), json.size());
+  Object obj = value.getObject(rt);
+  Array a = obj.getPropertyAsObject(rt, "a").getArray(rt);
+  EXPECT_EQ(a.size(rt), 3u);
+  EXPECT_EQ(a.getValueAtIndex(rt, 1).getNumber(), 2);
+  EXPECT_EQ(
+      a.getValueAtIndex(rt, 2)
+          .getObject(rt)
+          .getProperty(rt, "b")
+          .getString(rt)
+          .utf8(rt),
+      "\xc3\xa9t\xc3\xa9");
+  EXPECT_TRUE(obj.getProperty(rt, "c").isNull());
+
+  std::string bad = "{\"a\": ";
+  EXPECT_THROW(
+      Value::createFromJsonUtf8(
+          rt, reinterpret_cast<const uint8_t *>(bad.data()), bad.size()),
+      JSError);
+}
+
+TEST_P(V8RuntimeTest, Utf16Test) {
+  std::u16string text = u"caf\u00e9 \u20ac \U0001F600";
+  String str = v8runtime::createStringFromUtf16(rt, text.data(), text.size());
+  EXPECT_EQ(str.utf8(rt), "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80");
+  EXPECT_EQ(v8runtime::utf16(rt, str), text);
+
+  rt.global().setProperty(rt, "s", str);
+  EXPECT_EQ(eval("s.length").getNumber(), 9);
+  EXPECT_EQ(
+      v8runtime::utf16(rt, eval("'\\xe9t\\xe9'").getString(rt)),
+      u"\u00e9t\u00e9");
+
+  std::u16string out = u">";
+  v8runtime::appendUtf16(rt, eval("'abc'").getString(rt), out);
+  v8runtime::appendUtf16(rt, String::createFromAscii(rt, ""), out);
+  EXPECT_EQ(out, u">abc");
+
+  EXPECT_EQ(
+      v8runtime::createStringFromUtf16(rt, u"", 0).utf8(rt), std::string());
+}
+
+TEST_P(V8RuntimeTest, AppendUtf8Test) {
+  std::string out = ">";
+  v8runtime::appendUtf8(rt, eval("'plain ascii'").getString(rt), out);
+  EXPECT_EQ(out, ">plain ascii");
+
+  // One-byte strings with Latin-1 characters, at both ends.
+  out.clear();
+  v8runtime::appendUtf8(rt, eval("'\\xe9t\\xe9 \\xff'").getString(rt), out);
+  EXPECT_EQ(out, "\xc3\xa9t\xc3\xa9 \xc3\xbf");
+
+  // Two-byte strings, including a surrogate pair.
+  out.clear();
+  v8runtime::appendUtf8(
+      rt,
+      eval("'\\u20ac' + 'x'.repeat(100) + '\\ud83d\\ude00'").getString(rt),
+      out);
+  EXPECT_EQ(
+      out, "\xe2\x82\xac" + std::string(100, 'x') + "\xf0\x9f\x98\x80");
+
+  // Two-byte strings are encoded in chunks of 1024 code units; a pair split
+  // by a chunk boundary still comes out whole. Lone surrogates take three
+  // bytes.
+  out.clear();
+  v8runtime::appendUtf8(
+      rt,
+      eval("'\\u20ac'.repeat(1023) + '\\ud83d\\ude00' + "
+           "'\\u00e9'.repeat(2000) + '\\ud83d'")
+          .getString(rt),
+      out);
+  std::string expected;
+  for (int i = 0; i < 1023; i++)
+    expected += "\xe2\x82\xac";
+  expected += "\xf0\x9f\x98\x80";
+  for (int i = 0; i < 2000; i++)
+    expected += "\xc3\xa9";
+  expected += "\xed\xa0\xbd";
+  EXPECT_EQ(out, expected);
+
+  // Cons strings and long strings go through the same paths.
+  String big = eval("var s = 'ab'; for (var i = 0; i < 12; i++) s += s + "
+                    "'\\xe9'; s").getString(rt);
+  out.clear();
+  v8runtime::appendUtf8(rt, big, out);
+  EXPECT_EQ(out, big.utf8(rt));
+
+  out = "name=";
+  v8runtime::appendUtf8(rt, PropNameID::forUtf8(rt, "\xc3\xa9"), out);
+  EXPECT_EQ(out, "name=\xc3\xa9");
+}
+
+TEST_P(V8RuntimeTest, StringifyJsonUtf8Test) {
+  std::string json = "prefix:";
+  EXPECT_TRUE(v8runtime::stringifyJsonUtf8(
+      rt, eval("({a: [1, 'x'], b: '\u00e9', c: undefined})"), json));
+  EXPECT_EQ(json, "prefix:{\"a\":[1,\"x\"],\"b\":\"\xc3\xa9\"}");
+
+  json.clear();
+  EXPECT_TRUE(v8runtime::stringifyJsonUtf8(rt, Value(2.5), json));
+  EXPECT_EQ(json, "2.5");
+
+  json.clear();
+  EXPECT_TRUE(v8runtime::stringifyJsonUtf8(
+      rt, String::createFromAscii(rt, "undefined"), json));
+  EXPECT_EQ(json, "\"undefined\"");
+
+  json.clear();
+  EXPECT_FALSE(v8runtime::stringifyJsonUtf8(rt, Value(), json));
+  EXPECT_FALSE(v8runtime::stringifyJsonUtf8(rt, eval("(function() {})"), json));
+  EXPECT_EQ(json, "");
+
+  EXPECT_THROW(
+      v8runtime::stringifyJsonUtf8(rt, eval("o = {}; o.o = o; o"), json),
+      JSError);
+}
+
+TEST_P(V8RuntimeTest, LargeScriptSourceTest) {
+  // Large enough to be referenced as an external string when all ASCII.
+  std::string padding = "/*" + std::string(4096, '-') + "*/";
+  std::string ascii = padding + "var asciiResult = 'abc'.length; asciiResult";
+  std::string utf8 =
+      padding + "var utf8Result = '\xc3\xa9t\xc3\xa9'; utf8Result";
+
+  EXPECT_EQ(
+      rt.evaluateJavaScript(std::make_unique<StringBuffer>(ascii), "ascii.js")
+          .getNumber(),
+      3);
+  EXPECT_EQ(
+      rt.evaluateJavaScript(std::make_unique<StringBuffer>(utf8), "utf8.js")
+          .getString(rt)
+          .utf8(rt),
+      "\xc3\xa9t\xc3\xa9");
+
+  // A non ASCII byte anywhere, including the unaligned tail, disables it.
+  for (size_t offset : {size_t(2), size_t(70), padding.size() - 3}) {
+    std::string source = padding + "'ok'";
+    source[offset] = '\xc3';
+    source.insert(offset + 1, 1, '\xa9');
+    EXPECT_EQ(
+        rt.evaluateJavaScript(std::make_unique<StringBuffer>(source), "")
+            .getString(rt)
+            .utf8(rt),
+        "ok");
+  }
+
+  auto prepared = rt.prepareJavaScript(
+      std::make_shared<StringBuffer>(padding + "6 * 7"), "prepared.js");
+  EXPECT_EQ(rt.evaluatePreparedJavaScript(prepared).getNumber(), 42);
+}
+
+TEST_P(V8RuntimeTest, ArrayValuesTest) {
+  Value elements[] = {
+      Value(1), Value(rt, String::createFromAscii(rt, "two")), Value(true)};
+  Array array = v8runtime::createArrayFromValues(rt, elements, 3);
+  EXPECT_EQ(array.size(rt), 3u);
+  EXPECT_TRUE(function("function (a) { return a.join() === '1,two,true'; }")
+                  .call(rt, array)
+                  .getBool());
+  EXPECT_EQ(v8runtime::createArrayFromValues(rt, nullptr, 0).size(rt), 0u);
+
+  std::vector<Value> values;
+  v8runtime::getArrayValues(rt, array, values);
+  ASSERT_EQ(values.size(), 3u);
+  EXPECT_EQ(values[0].getNumber(), 1);
+  EXPECT_EQ(values[1].getString(rt).utf8(rt), "two");
+  EXPECT_TRUE(values[2].getBool());
+
+  v8runtime::getArrayValues(rt, array, values, 1, 1);
+  ASSERT_EQ(values.size(), 1u);
+  EXPECT_EQ(values[0].getString(rt).utf8(rt), "two");
+
+  v8runtime::getArrayValues(rt, array, values, 2, 10);
+  ASSERT_EQ(values.size(), 1u);
+  EXPECT_TRUE(values[0].getBool());
+
+  v8runtime::getArrayValues(rt, array, values, 5);
+  EXPECT_TRUE(values.empty());
+
+  Array throwing =
+      eval("var a = [1, 2]; Object.defineProperty(a, 1, "
+           "{get() { throw new Error('nope'); }}); a")
+          .getObject(rt)
+          .getArray(rt);
+  EXPECT_THROW(v8runtime::getArrayValues(rt, throwing, values), JSError);
+}
+
+// Run with --gtest_also_run_disabled_tests.
+TEST_P(V8RuntimeTest, DISABLED_ArrayValuesBenchmark) {
+  constexpr size_t kLength = 100000;
+  std::vector<Value> elements;
+  elements.reserve(kLength);
+  for (size_t i = 0; i < kLength; i++) {
+    elements.emplace_back(static_cast<double>(i));
+  }
+
+  std::vector<Value> values;
+  values.reserve(kLength);
+
+  Measure("per element", 1, [&] {
+    Array perElement(rt, kLength);
+    for (size_t i = 0; i < kLength; i++) {
+      perElement.setValueAtIndex(rt, i, elements[i]);
+    }
+    values.clear();
+    for (size_t i = 0; i < kLength; i++) {
+      values.push_back(perElement.getValueAtIndex(rt, i));
+    }
+  });
+
+  Measure("bulk", 1, [&] {
+    Array bulk =
+        v8runtime::createArrayFromValues(rt, elements.data(), kLength);
+    v8runtime::getArrayValues(rt, bulk, values);
+  });
+}
+
+TEST_P(V8RuntimeTest, GetSetPropertiesTest) {
+  PropNameID names[] = {
+      PropNameID::forAscii(rt, "x"),
+      PropNameID::forAscii(rt, "y"),
+      PropNameID::forAscii(rt, "missing"),
+      PropNameID::forAscii(rt, "computed")};
+  Object obj =
+      eval("({x: 1, y: 'two', get computed() { return this.x * 10; }})")
+          .getObject(rt);
+
+  Value values[4];
+  v8runtime::getProperties(rt, obj, names, 4, values);
+  EXPECT_EQ(values[0].getNumber(), 1);
+  EXPECT_EQ(values[1].getString(rt).utf8(rt), "two");
+  EXPECT_TRUE(values[2].isUndefined());
+  EXPECT_EQ(values[3].getNumber(), 10);
+
+  Value updates[] = {Value(5), Value(rt, obj), Value(true)};
+  v8runtime::setProperties(rt, obj, names, updates, 3);
+  EXPECT_EQ(obj.getProperty(rt, "x").getNumber(), 5);
+  EXPECT_TRUE(Object::strictEquals(
+      rt, obj.getPropertyAsObject(rt, "y"), obj));
+  EXPECT_TRUE(obj.getProperty(rt, "missing").getBool());
+  EXPECT_EQ(obj.getProperty(rt, "computed").getNumber(), 50);
+
+  Object throwing =
+      eval("({get x() { throw new Error('nope'); }})").getObject(rt);
+  EXPECT_THROW(
+      v8runtime::getProperties(rt, throwing, names, 1, values), JSError);
+  EXPECT_THROW(
+      v8runtime::setProperties(
+          rt, throwing, names + 3, updates, 1),
+      JSError);
+}
+
+TEST_P(V8RuntimeTest, GetOwnPropertiesTest) {
+  Object obj =
+      eval("o = Object.create({inherited: 1}); o.b = 'two'; o[7] = 7; "
+           "Object.defineProperty(o, 'hidden', {value: 3}); "
+           "o[Symbol('s')] = 4; o.a = {x: 1}; o")
+          .getObject(rt);
+
+  std::vector<PropNameID> names;
+  std::vector<Value> values;
+  v8runtime::getOwnProperties(rt, obj, names, values);
+  ASSERT_EQ(names.size(), 3u);
+  ASSERT_EQ(values.size(), 3u);
+  EXPECT_EQ(names[0].utf8(rt), "7");
+  EXPECT_EQ(values[0].getNumber(), 7);
+  EXPECT_EQ(names[1].utf8(rt), "b");
+  EXPECT_EQ(values[1].getString(rt).utf8(rt), "two");
+  EXPECT_EQ(names[2].utf8(rt), "a");
+  EXPECT_EQ(values[2].getObject(rt).getProperty(rt, "x").getNumber(), 1);
+
+  // The names can be used as property keys and the vectors are reused.
+  EXPECT_EQ(obj.getProperty(rt, names[1]).getString(rt).utf8(rt), "two");
+  v8runtime::getOwnProperties(rt, Object(rt), names, values);
+  EXPECT_TRUE(names.empty());
+  EXPECT_TRUE(values.empty());
+}
+
+namespace {
+
+// Prints a visited value tree in a JSON like notation.
+class TreePrinter : public v8runtime::ValueTreeVisitor {
+ public:
+  void null() override {
+    separate();
+    out += "null";
+  }
+  void boolean(bool value) override {
+    separate();
+    out += value ? "true" : "false";
+  }
+  void number(double value) override {
+    separate();
+    std::ostringstream stream;
+    stream << value;
+    out += stream.str();
+  }
+  void string(const char *utf8, size_t length) override {
+    separate();
+    out += "'" + std::string(utf8, length) + "'";
+  }
+  void beginArray(size_t /*length*/) override {
+    separate();
+    out += "[";
+  }
+  void endArray() override {
+    out += "]";
+  }
+  void beginObject() override {
+    separate();
+    out += "{";
+  }
+  void key(const char *utf8, size_t length) override {
+    separate();
+    out += std::string(utf8, length) + ":";
+  }
+  void endObject() override {
+    out += "}";
+  }
+
+  std::string out;
+
+ private:
+  void separate() {
+    if (!out.empty() && out.back() != '[' && out.back() != '{' &&
+        out.back() != ':')
+      out += ",";
+  }
+};
+
+// Produces a tree with the given depth, where every level holds width
+// numbers, strings and objects.
+void produceTree(v8runtime::ValueTreeVisitor &visitor, int depth, int width) {
+  static const char *keys[] = {"alpha", "beta", "gamma", "delta"};
+  visitor.beginObject();
+  for (int i = 0; i < width; i++) {
+    const char *key = keys[i % 4];
+    visitor.key(key, strlen(key));
+    visitor.beginArray(3);
+    visitor.number(i);
+    visitor.string("item", 4);
+    if (depth > 0)
+      produceTree(visitor, depth - 1, width);
+    else
+      visitor.null();
+    visitor.endArray();
+  }
+  visitor.endObject();
+}
+
+} // namespace
+
+TEST_P(V8RuntimeTest, ValueTreeTest) {
+  TreePrinter printer;
+  v8runtime::visitValueTree(
+      rt,
+      eval("({a: [1, 'x', null, undefined, true], b: {c: 2.5}, d: undefined, "
+           "e: function() {}, 3: false})"),
+      printer);
+  EXPECT_EQ(
+      printer.out, "{3:false,a:[1,'x',null,null,true],b:{c:2.5},e:null}");
+
+  TreePrinter inherited;
+  v8runtime::visitValueTree(
+      rt, eval("Object.create({p: 1}, {q: {value: 2, enumerable: true}})"),
+      inherited);
+  EXPECT_EQ(inherited.out, "{q:2,p:1}");
+
+  TreePrinter ignored;
+  EXPECT_THROW(
+      v8runtime::visitValueTree(rt, eval("[function() {}]"), ignored),
+      JSError);
+  EXPECT_THROW(
+      v8runtime::visitValueTree(
+          rt, eval("({get x() { throw new Error('boom'); }})"), ignored),
+      JSError);
+
+  Value built = v8runtime::buildValueTree(
+      rt, [](v8runtime::ValueTreeVisitor &visitor) {
+        visitor.beginObject();
+        visitor.key("list", 4);
+        visitor.beginArray(2);
+        visitor.number(1);
+        visitor.string("\xc3\xa9", 2);
+        visitor.endArray();
+        visitor.key("flag", 4);
+        visitor.boolean(true);
+        visitor.key("none", 4);
+        visitor.null();
+        visitor.endObject();
+      });
+  EXPECT_EQ(
+      function("function(v) { return JSON.stringify(v); }")
+          .call(rt, built)
+          .getString(rt)
+          .utf8(rt),
+      "{\"list\":[1,\"\xc3\xa9\"],\"flag\":true,\"none\":null}");
+
+  // The round trip through both directions is lossless.
+  Value tree = v8runtime::buildValueTree(
+      rt, [](v8runtime::ValueTreeVisitor &visitor) {
+        produceTree(visitor, 2, 3);
+      });
+  TreePrinter expected;
+  produceTree(expected, 2, 3);
+  TreePrinter actual;
+  v8runtime::visitValueTree(rt, tree, actual);
+  EXPECT_EQ(actual.out, expected.out);
+
+  EXPECT_THROW(
+      v8runtime::buildValueTree(
+          rt,
+          [](v8runtime::ValueTreeVisitor &visitor) { visitor.beginArray(1); }),
+      JSINativeException);
+}
+
+// Run with --gtest_also_run_disabled_tests.
+TEST_P(V8RuntimeTest, DISABLED_ValueTreeBenchmark) {
+  struct Shape {
+    const char *name;
+    int depth;
+    int width;
+  };
+  const Shape shapes[] = {{"deep", 12, 2}, {"wide", 1, 300}};
+  const int kIterations = 20;
+
+  auto measure = [&](const Shape &shape,
+                     const char *label,
+                     const std::function<void()> &run) {
+    Measure(std::string(shape.name) + " " + label, kIterations, run);
+  };
+
+  // Builds the same tree as produceTree one JSI call per node, like
+  // jsi::valueFromDynamic.
+  std::function<Value(int, int)> buildWithJsi = [&](int depth, int width) {
+    static const char *keys[] = {"alpha", "beta", "gamma", "delta"};
+    Object obj(rt);
+    for (int i = 0; i < width; i++) {
+      Array array(rt, 3);
+      array.setValueAtIndex(rt, 0, i);
+      array.setValueAtIndex(rt, 1, String::createFromUtf8(rt, "item"));
+      array.setValueAtIndex(
+          rt, 2, depth > 0 ? buildWithJsi(depth - 1, width) : Value::null());
+      obj.setProperty(rt, PropNameID::forUtf8(rt, keys[i % 4]), array);
+    }
+    return Value(rt, obj);
+  };
+
+  // Reads a tree one JSI call per node, like jsi::dynamicFromValue.
+  std::function<size_t(const Value &)> readWithJsi = [&](const Value &value) {
+    if (!value.isObject())
+      return value.isString() ? value.getString(rt).utf8(rt).size() : 1;
+    Object obj = value.getObject(rt);
+    size_t nodes = 1;
+    if (obj.isArray(rt)) {
+      Array array = obj.getArray(rt);
+      for (size_t i = 0; i < array.size(rt); i++)
+        nodes += readWithJsi(array.getValueAtIndex(rt, i));
+      return nodes;
+    }
+    Array names = obj.getPropertyNames(rt);
+    for (size_t i = 0; i < names.size(rt); i++) {
+      String name = names.getValueAtIndex(rt, i).getString(rt);
+      nodes += name.utf8(rt).size();
+      nodes += readWithJsi(obj.getProperty(rt, name));
+    }
+    return nodes;
+  };
+
+  for (const Shape &shape : shapes) {
+    measure(shape, "buildValueTree", [&] {
+      v8runtime::buildValueTree(rt, [&](v8runtime::ValueTreeVisitor &visitor) {
+        produceTree(visitor, shape.depth, shape.width);
+      });
+    });
+    measure(shape, "build through JSI", [&] {
+      buildWithJsi(shape.depth, shape.width);
+    });
+
+    Value tree = buildWithJsi(shape.depth, shape.width);
+    measure(shape, "visitValueTree", [&] {
+      TreePrinter printer;
+      v8runtime::visitValueTree(rt, tree, printer);
+    });
+    measure(shape, "read through JSI", [&] { readWithJsi(tree); });
+  }
+}
+
+// Run with --gtest_also_run_disabled_tests.
+TEST_P(V8RuntimeTest, DISABLED_JsonParseBenchmark) {
+  std::string json = "[";
+  for (int i = 0; i < 10000; i++) {
+    if (i != 0)
+      json += ",";
+    json += "{\"id\": " + std::to_string(i) +
+        ", \"name\": \"item\", \"tags\": [\"x\", \"y\"], \"ok\": true}";
+  }
+  json += "]";
+  const uint8_t *data = reinterpret_cast<const uint8_t *>(json.data());
+  const int kIterations = 50;
+  std::cout << "parsing " << json.size() << " bytes per run" << std::endl;
+
+  Measure("v8::JSON::Parse", kIterations, [&] {
+    Value::createFromJsonUtf8(rt, data, json.size());
+  });
+  Measure("JSON.parse through JSI", kIterations, [&] {
+    rt.global()
+        .getPropertyAsObject(rt, "JSON")
+        .getPropertyAsFunction(rt, "parse")
+        .call(rt, String::createFromUtf8(rt, data, json.size()));
+  });
+}
+
+// Run with --gtest_also_run_disabled_tests.
+// Compares the borrowed arguments host functions get now with the copying
+// they used to pay for: a std::vector of jsi::Values, each string and object
+// backed by its own global handle, plus one for this. The baseline's callback
+// does that copy on top of the call itself.
+TEST_P(V8RuntimeTest, DISABLED_HostFunctionCallBenchmark) {
+  Function borrowed = Function::createFromHostFunction(
+      rt,
+      PropNameID::forAscii(rt, "borrowed"),
+      0,
+      [](Runtime &, const Value &, const Value * /*args*/, size_t count) {
+        return Value(static_cast<int>(count));
+      });
+  Function copied = Function::createFromHostFunction(
+      rt,
+      PropNameID::forAscii(rt, "copied"),
+      0,
+      [](Runtime &rt, const Value &thisVal, const Value *args, size_t count) {
+        std::vector<Value> argsVector;
+        for (size_t i = 0; i < count; i++) {
+          argsVector.emplace_back(rt, args[i]);
+        }
+        Value thisCopy(rt, thisVal);
+        return Value(static_cast<int>(argsVector.size()));
+      });
+
+  // Each run makes 10000 calls.
+  const int kRuns = 100;
+  Function loop = function(
+      "function(hf) { var o = {}; for (var i = 0; i < 10000; i++) "
+      "hf(i, o, 'x'); }");
+
+  double copiedTime = Measure("copied arguments (baseline)", kRuns, [&] {
+    loop.call(rt, copied);
+  });
+  double borrowedTime = Measure(
+      "borrowed arguments", kRuns, [&] { loop.call(rt, borrowed); });
+  std::cout << "speedup: " << copiedTime / borrowedTime << "x" << std::endl;
+}
+
+INSTANTIATE_TEST_CASE_P(
+    Runtimes,
+    V8RuntimeTest,
+    ::testing::ValuesIn(runtimeGenerators()));